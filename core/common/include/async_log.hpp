@@ -0,0 +1,385 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <strings.h>
+#include <thread>
+#include <vector>
+
+namespace RF {
+
+enum class LogLevel : uint8_t { Debug, Info, Success, Warn, Error, Off };
+
+// State of one RF_LOG call site, for rate limiting and deduplication
+struct LogSite {
+    LogSite(const char* file, int line, LogLevel level);  // registers with the Logger
+
+    const char* file;
+    int line;
+    LogLevel level;
+    std::atomic<int64_t> window_start_ns{0};
+    std::atomic<uint32_t> in_window{0};   // messages let through this window
+    std::atomic<uint32_t> suppressed{0};  // held back since the last one written
+    std::atomic<uint64_t> last_hash{0};   // text of the last one written
+};
+
+// Logging that never blocks the thread that logs.
+//
+// Each thread formats its messages straight into a ring of its own (single
+// producer, no locks; the first message from a thread registers the ring,
+// which is one allocation). A background thread drains all rings every
+// FLUSH_INTERVAL, orders the records by time and writes them in one go:
+// warnings and errors to stderr, the rest to stdout, with the usual
+// "[ERROR] " style prefixes. A full ring drops (and counts) instead of
+// waiting.
+//
+// Every call site is rate limited: within a window_ns window a site writes
+// at most `burst` messages and never the same text twice. What it held back
+// is reported with the next message it writes, or by the writer once the
+// window is over. Over the limit a call costs a few atomics, no formatting.
+//
+// The level comes from RF_LOG_LEVEL (debug, info, warn, error, off) and can
+// be changed with set_level(). Use the RF_LOG_* macros below.
+class Logger {
+public:
+    static constexpr size_t TEXT_SIZE = 224;
+    static constexpr size_t RING_SIZE = 256;  // records per thread, power of two
+    static constexpr int64_t FLUSH_INTERVAL_NS = 20000000;  // 20 ms
+
+    // Never destroyed; flushed and stopped at exit. Messages logged after
+    // that are written synchronously.
+    static Logger& instance() {
+        static Logger* logger = create();
+        return *logger;
+    }
+
+    bool enabled(LogLevel level) const {
+        return level >= m_level.load(std::memory_order_relaxed) && level != LogLevel::Off;
+    }
+    void set_level(LogLevel level) { m_level.store(level, std::memory_order_relaxed); }
+    LogLevel level() const { return m_level.load(std::memory_order_relaxed); }
+
+    // Per call site: at most `burst` messages every window_ns
+    void set_rate_limit(uint32_t burst, int64_t window_ns) {
+        m_burst.store(burst, std::memory_order_relaxed);
+        m_window_ns.store(window_ns, std::memory_order_relaxed);
+    }
+
+    // Messages lost to full rings so far
+    uint64_t dropped() const { return m_dropped_total.load(std::memory_order_relaxed); }
+
+    __attribute__((format(printf, 4, 5)))
+    void log(LogSite& site, LogLevel level, const char* fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        vlog(site, level, fmt, args);
+        va_end(args);
+    }
+
+    void vlog(LogSite& site, LogLevel level, const char* fmt, va_list args) {
+        if (!enabled(level)) return;
+        int64_t now = monotonic_ns();
+
+        // Over the burst limit: nothing to format
+        if (now - site.window_start_ns.load(std::memory_order_relaxed) < m_window_ns.load(std::memory_order_relaxed) &&
+            site.in_window.load(std::memory_order_relaxed) >= m_burst.load(std::memory_order_relaxed)) {
+            site.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (m_stopped.load(std::memory_order_acquire)) {
+            char text[TEXT_SIZE];
+            vsnprintf(text, sizeof(text), fmt, args);
+            write_line(level, text, 0);
+            return;
+        }
+
+        Ring* ring = thread_ring();
+        Record* record = ring ? ring->reserve() : nullptr;
+        if (!record) {
+            if (ring) ring->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        int n = vsnprintf(record->text, TEXT_SIZE, fmt, args);
+        record->length = static_cast<uint16_t>(std::min<size_t>(n < 0 ? 0 : n, TEXT_SIZE - 1));
+        if (!admit(site, hash(record->text, record->length), now)) return;
+
+        record->time_ns = now;
+        record->level = level;
+        record->suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+        ring->publish();
+    }
+
+    // Wait until everything logged before the call has been written. Blocks
+    // the caller: for shutdown and tools, not for hot paths.
+    void flush() {
+        if (m_stopped.load(std::memory_order_acquire)) return;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        uint64_t target = ++m_flush_requested;
+        m_cv.notify_all();
+        m_flushed_cv.wait(lock, [&] { return m_flush_done >= target || m_stopped.load(); });
+    }
+
+    void add_site(LogSite* site) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sites.push_back(site);
+    }
+
+private:
+    struct Record {
+        int64_t time_ns;
+        LogLevel level;
+        uint16_t length;
+        uint32_t suppressed;
+        char text[TEXT_SIZE];
+    };
+
+    // Single producer (the owning thread), single consumer (the writer)
+    struct Ring {
+        Record records[RING_SIZE];
+        std::atomic<uint64_t> head{0};  // next to write, producer
+        std::atomic<uint64_t> tail{0};  // next to read, writer
+        std::atomic<uint64_t> dropped{0};
+        std::atomic_bool retired{false};  // owning thread has exited
+
+        Record* reserve() {
+            uint64_t h = head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) >= RING_SIZE) return nullptr;
+            return &records[h & (RING_SIZE - 1)];
+        }
+        void publish() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+    };
+
+    // Retires the ring when its thread exits
+    struct ThreadRing {
+        std::shared_ptr<Ring> ring;
+        ~ThreadRing() {
+            if (ring) ring->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    Logger() {
+        if (const char* env = getenv("RF_LOG_LEVEL")) {
+            static const struct { const char* name; LogLevel level; } names[] = {
+                {"debug", LogLevel::Debug}, {"info", LogLevel::Info}, {"warn", LogLevel::Warn},
+                {"error", LogLevel::Error}, {"off", LogLevel::Off},
+            };
+            for (const auto& n : names) {
+                if (strcasecmp(env, n.name) == 0) m_level.store(n.level);
+            }
+        }
+        m_thread = std::thread(&Logger::run, this);
+    }
+
+    static Logger* create() {
+        Logger* logger = new Logger();
+        std::atexit([] { instance().stop(); });
+        return logger;
+    }
+
+    static int64_t monotonic_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return int64_t(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    }
+
+    static uint64_t hash(const char* s, size_t len) {
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = 0; i < len; i++) h = (h ^ static_cast<uint8_t>(s[i])) * 1099511628211ull;
+        return h | 1;  // 0 = nothing written yet
+    }
+
+    // Rate limit and dedup for one call site. Racy across threads sharing
+    // a site, which at worst lets an extra message through.
+    bool admit(LogSite& site, uint64_t text_hash, int64_t now) {
+        int64_t window = m_window_ns.load(std::memory_order_relaxed);
+        if (now - site.window_start_ns.load(std::memory_order_relaxed) >= window) {
+            site.window_start_ns.store(now, std::memory_order_relaxed);
+            site.in_window.store(0, std::memory_order_relaxed);
+            site.last_hash.store(0, std::memory_order_relaxed);
+        }
+        // Repeats count against the burst too, so a flood of one message
+        // soon takes the no-format path in vlog()
+        uint32_t seen = site.in_window.fetch_add(1, std::memory_order_relaxed);
+        bool repeat = site.last_hash.load(std::memory_order_relaxed) == text_hash;
+        if (repeat || seen >= m_burst.load(std::memory_order_relaxed)) {
+            site.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        site.last_hash.store(text_hash, std::memory_order_relaxed);
+        return true;
+    }
+
+    Ring* thread_ring() {
+        static thread_local ThreadRing t_ring;
+        if (!t_ring.ring) {
+            t_ring.ring = std::make_shared<Ring>();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_rings.push_back(t_ring.ring);
+        }
+        return t_ring.ring.get();
+    }
+
+    static const char* prefix(LogLevel level) {
+        switch (level) {
+            case LogLevel::Debug: return "[DEBUG] ";
+            case LogLevel::Info: return "[INFO] ";
+            case LogLevel::Success: return "[SUCCESS] ";
+            case LogLevel::Warn: return "[WARN] ";
+            default: return "[ERROR] ";
+        }
+    }
+
+    static void write_line(LogLevel level, const char* text, uint32_t suppressed) {
+        FILE* out = level >= LogLevel::Warn ? stderr : stdout;
+        if (suppressed > 0) {
+            fprintf(out, "%s%s (%u similar suppressed)\n", prefix(level), text, suppressed);
+        } else {
+            fprintf(out, "%s%s\n", prefix(level), text);
+        }
+    }
+
+    // Writer thread: everything published so far, in time order. `final`
+    // (at exit) also reports what sites held back in their current window.
+    void drain(bool final = false) {
+        std::vector<std::shared_ptr<Ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            rings = m_rings;
+        }
+
+        m_batch.clear();
+        uint64_t dropped = 0;
+        for (auto& ring : rings) {
+            uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            for (; tail != head; tail++) m_batch.push_back(ring->records[tail & (RING_SIZE - 1)]);
+            ring->tail.store(tail, std::memory_order_release);
+            dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+        }
+
+        std::stable_sort(m_batch.begin(), m_batch.end(),
+                         [](const Record& a, const Record& b) { return a.time_ns < b.time_ns; });
+        bool out = false, err = false;
+        for (const Record& r : m_batch) {
+            write_line(r.level, r.text, r.suppressed);
+            (r.level >= LogLevel::Warn ? err : out) = true;
+        }
+        if (dropped > 0) {
+            m_dropped_total.fetch_add(dropped, std::memory_order_relaxed);
+            char text[64];
+            snprintf(text, sizeof(text), "Log: %llu messages dropped (ring full)",
+                     static_cast<unsigned long long>(dropped));
+            write_line(LogLevel::Warn, text, 0);
+            err = true;
+        }
+        report_suppressed(out, err, final);
+        if (out) fflush(stdout);
+        if (err) fflush(stderr);
+
+        // Forget rings of exited threads once they are empty
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(), [](const std::shared_ptr<Ring>& r) {
+                          return r->retired.load(std::memory_order_acquire) &&
+                                 r->tail.load(std::memory_order_relaxed) == r->head.load(std::memory_order_acquire);
+                      }),
+                      m_rings.end());
+    }
+
+    // Sites that went quiet with messages held back: say how many
+    void report_suppressed(bool& out, bool& err, bool final) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        int64_t now = monotonic_ns();
+        int64_t window = m_window_ns.load(std::memory_order_relaxed);
+        for (LogSite* site : m_sites) {
+            if (site->suppressed.load(std::memory_order_relaxed) == 0 ||
+                (!final && now - site->window_start_ns.load(std::memory_order_relaxed) < window)) {
+                continue;
+            }
+            uint32_t n = site->suppressed.exchange(0, std::memory_order_relaxed);
+            if (n == 0) continue;
+            const char* file = strrchr(site->file, '/');
+            char text[128];
+            snprintf(text, sizeof(text), "%s:%d: %u similar messages suppressed",
+                     file ? file + 1 : site->file, site->line, n);
+            write_line(site->level, text, 0);
+            (site->level >= LogLevel::Warn ? err : out) = true;
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop) {
+            m_cv.wait_for(lock, std::chrono::nanoseconds(FLUSH_INTERVAL_NS),
+                          [&] { return m_stop || m_flush_requested > m_flush_done; });
+            uint64_t requested = m_flush_requested;
+            lock.unlock();
+            drain();
+            lock.lock();
+            m_flush_done = requested;
+            m_flushed_cv.notify_all();
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        if (m_thread.joinable()) m_thread.join();
+        drain(true);
+        m_stopped.store(true, std::memory_order_release);
+        m_flushed_cv.notify_all();
+    }
+
+    std::atomic<LogLevel> m_level{LogLevel::Info};
+    std::atomic<uint32_t> m_burst{5};
+    std::atomic<int64_t> m_window_ns{1000000000};  // 1 s
+    std::atomic<uint64_t> m_dropped_total{0};
+    std::atomic_bool m_stopped{false};
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;          // wakes the writer early (flush, stop)
+    std::condition_variable m_flushed_cv;
+    std::vector<std::shared_ptr<Ring>> m_rings;
+    std::vector<LogSite*> m_sites;  // static, never removed
+    uint64_t m_flush_requested = 0;
+    uint64_t m_flush_done = 0;
+    bool m_stop = false;
+
+    std::vector<Record> m_batch;  // writer thread only
+    std::thread m_thread;
+};
+
+inline LogSite::LogSite(const char* file, int line, LogLevel level) : file(file), line(line), level(level) {
+    Logger::instance().add_site(this);
+}
+
+} // namespace RF
+
+// printf-style; arguments are not evaluated when the level is disabled
+#define RF_LOG(level, ...)                                                      \
+    do {                                                                        \
+        if (::RF::Logger::instance().enabled(level)) {                          \
+            static ::RF::LogSite rf_log_site_(__FILE__, __LINE__, level);       \
+            ::RF::Logger::instance().log(rf_log_site_, level, __VA_ARGS__);     \
+        }                                                                       \
+    } while (0)
+
+#define RF_LOG_DEBUG(...) RF_LOG(::RF::LogLevel::Debug, __VA_ARGS__)
+#define RF_LOG_INFO(...) RF_LOG(::RF::LogLevel::Info, __VA_ARGS__)
+#define RF_LOG_SUCCESS(...) RF_LOG(::RF::LogLevel::Success, __VA_ARGS__)
+#define RF_LOG_WARN(...) RF_LOG(::RF::LogLevel::Warn, __VA_ARGS__)
+#define RF_LOG_ERROR(...) RF_LOG(::RF::LogLevel::Error, __VA_ARGS__)
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace RF {
+
+// Lock-free log-linear (HDR-style) histogram of nanosecond latencies.
+//
+// Values below 2^SUB_BITS ns get exact buckets; above that each power of two
+// is split into 2^SUB_BITS linear sub-buckets, so any recorded value is
+// reported within ~3% of its true value. Recording is a couple of relaxed
+// atomic adds, cheap enough to leave on in production. Readers see a
+// consistent-enough view without stopping the writer.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr int SUB_COUNT = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    void record(uint64_t ns) {
+        m_buckets[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_total_ns.fetch_add(ns, std::memory_order_relaxed);
+
+        uint64_t max = m_max_ns.load(std::memory_order_relaxed);
+        while (ns > max && !m_max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t max() const { return m_max_ns.load(std::memory_order_relaxed); }
+
+    double mean() const {
+        uint64_t n = count();
+        return n ? double(m_total_ns.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    // Value at percentile p (0-100), as the midpoint of its bucket
+    uint64_t percentile(double p) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * n + 0.5);
+        if (rank == 0) rank = 1;
+        if (rank > n) rank = n;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += m_buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                uint64_t mid = bucket_low(i) + bucket_width(i) / 2;
+                return mid < max() ? mid : max();
+            }
+        }
+        return max();
+    }
+
+    void reset() {
+        for (auto& b : m_buckets) b.store(0, std::memory_order_relaxed);
+        m_count.store(0, std::memory_order_relaxed);
+        m_total_ns.store(0, std::memory_order_relaxed);
+        m_max_ns.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static int bucket_of(uint64_t v) {
+        if (v < SUB_COUNT) return static_cast<int>(v);
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - SUB_BITS;
+        int sub = static_cast<int>((v >> shift) & (SUB_COUNT - 1));
+        return (shift + 1) * SUB_COUNT + sub;
+    }
+
+    static uint64_t bucket_low(int i) {
+        if (i < SUB_COUNT) return i;
+        int shift = i / SUB_COUNT - 1;
+        uint64_t sub = i % SUB_COUNT;
+        return (uint64_t(SUB_COUNT) + sub) << shift;
+    }
+
+    static uint64_t bucket_width(int i) {
+        if (i < SUB_COUNT) return 1;
+        return uint64_t(1) << (i / SUB_COUNT - 1);
+    }
+
+    std::atomic<uint64_t> m_buckets[BUCKETS] = {};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_total_ns{0};
+    std::atomic<uint64_t> m_max_ns{0};
+};
+
+// Stages of one SOAP exchange
+enum class ExchangeStage {
+    SocketAcquire,  // SocketPool::get_socket()
+    RequestBuild,   // filling the ExchangeRequest template
+    Send,           // send()
+    FirstByte,      // send done -> first reply byte readable
+    Receive,        // send done -> complete reply
+    Parse,          // parse_reply()
+    CommandAge,     // command produced (its stamp) -> picked for a request
+    InputToSend,    // input event -> first request carrying it sent
+    InputToState,   // input event -> state from the reply to that request published
+    COUNT
+};
+
+inline const char* stage_name(ExchangeStage stage) {
+    switch (stage) {
+        case ExchangeStage::SocketAcquire: return "socket_acquire";
+        case ExchangeStage::RequestBuild:  return "request_build";
+        case ExchangeStage::Send:          return "send";
+        case ExchangeStage::FirstByte:     return "first_byte";
+        case ExchangeStage::Receive:       return "receive";
+        case ExchangeStage::Parse:         return "parse";
+        case ExchangeStage::CommandAge:    return "command_age";
+        case ExchangeStage::InputToSend:   return "input_to_send";
+        case ExchangeStage::InputToState:  return "input_to_state";
+        default:                           return "?";
+    }
+}
+
+struct LatencySummary {
+    uint64_t count = 0;
+    double mean_us = 0;
+    double p50_us = 0;
+    double p90_us = 0;
+    double p99_us = 0;
+    double p999_us = 0;
+    double max_us = 0;
+};
+
+// One histogram per ExchangeStage
+class ExchangeLatency {
+public:
+    static constexpr int NUM_STAGES = static_cast<int>(ExchangeStage::COUNT);
+
+    void record(ExchangeStage stage, std::chrono::steady_clock::time_point from,
+                std::chrono::steady_clock::time_point to) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+        record_ns(stage, ns > 0 ? static_cast<uint64_t>(ns) : 0);
+    }
+
+    void record_ns(ExchangeStage stage, uint64_t ns) {
+        m_stages[static_cast<int>(stage)].record(ns);
+    }
+
+    LatencySummary summary(ExchangeStage stage) const {
+        const LatencyHistogram& h = m_stages[static_cast<int>(stage)];
+        LatencySummary s;
+        s.count = h.count();
+        s.mean_us = h.mean() / 1e3;
+        s.p50_us = h.percentile(50) / 1e3;
+        s.p90_us = h.percentile(90) / 1e3;
+        s.p99_us = h.percentile(99) / 1e3;
+        s.p999_us = h.percentile(99.9) / 1e3;
+        s.max_us = h.max() / 1e3;
+        return s;
+    }
+
+    void reset() {
+        for (auto& h : m_stages) h.reset();
+    }
+
+    // Human readable table, one line per stage
+    void print(FILE* out) const {
+        fprintf(out, "%-15s %10s %10s %10s %10s %10s %10s %10s\n",
+                "stage", "count", "mean_us", "p50_us", "p90_us", "p99_us", "p99.9_us", "max_us");
+        for (int i = 0; i < NUM_STAGES; i++) {
+            LatencySummary s = summary(static_cast<ExchangeStage>(i));
+            fprintf(out, "%-15s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                    stage_name(static_cast<ExchangeStage>(i)), (unsigned long long)s.count,
+                    s.mean_us, s.p50_us, s.p90_us, s.p99_us, s.p999_us, s.max_us);
+        }
+    }
+
+private:
+    LatencyHistogram m_stages[NUM_STAGES];
+};
+
+} // namespace RF
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <type_traits>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace RF {
+
+// Single-writer / multi-reader sequence lock.
+//
+// The writer never blocks and never waits for readers. Readers copy the value
+// and retry if a write overlapped the copy, so they always get one coherent T.
+// The payload is held in relaxed atomic words so the overlapping copy is not
+// a data race.
+//
+// wait_for_update() lets readers sleep until the next store() instead of
+// polling. It uses a futex; the writer only makes the wake syscall when
+// someone is actually waiting.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable T");
+
+public:
+    SeqLock() {
+        T initial{};
+        store_words(initial);
+    }
+
+    // Writer only
+    void store(const T& value) {
+        uint64_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        store_words(value);
+
+        m_seq.store(seq + 2, std::memory_order_release);
+
+        // seq_cst pairs with the waiter's increment below: either we see
+        // the waiter, or its FUTEX_WAIT sees the new epoch and returns.
+        // Release/acquire would let the load pass the bump and lose the wake.
+        m_epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_seq_cst) > 0) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), FUTEX_WAKE_PRIVATE, INT32_MAX,
+                    nullptr, nullptr, 0);
+        }
+    }
+
+    // Copy out the latest value. Returns the number of store()s so far.
+    uint64_t load(T& out) const {
+        while (true) {
+            uint64_t before = m_seq.load(std::memory_order_acquire);
+            if (before & 1) continue;  // write in progress
+
+            uint64_t words[WORDS];
+            for (size_t i = 0; i < WORDS; i++) {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (m_seq.load(std::memory_order_relaxed) == before) {
+                memcpy(&out, words, sizeof(T));
+                return before / 2;
+            }
+        }
+    }
+
+    // Number of store()s so far, without copying the value
+    uint64_t version() const {
+        return m_seq.load(std::memory_order_acquire) / 2;
+    }
+
+    // Block until version() > after or timeout_ms passes (< 0 waits forever).
+    // Returns the current version.
+    uint64_t wait_for_update(uint64_t after, int timeout_ms = -1) const {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        if (timeout_ms >= 0) {
+            deadline.tv_sec += timeout_ms / 1000;
+            deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+        }
+
+        while (true) {
+            // Read the futex word before checking, so a store() in between
+            // changes it and the wait below returns immediately
+            uint32_t epoch = m_epoch.load(std::memory_order_acquire);
+            uint64_t current = version();
+            if (current > after) return current;
+
+            struct timespec remaining;
+            struct timespec* timeout = nullptr;
+            if (timeout_ms >= 0) {
+                struct timespec now;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                int64_t ns = (deadline.tv_sec - now.tv_sec) * 1000000000L + (deadline.tv_nsec - now.tv_nsec);
+                if (ns <= 0) return current;
+                remaining.tv_sec = ns / 1000000000L;
+                remaining.tv_nsec = ns % 1000000000L;
+                timeout = &remaining;
+            }
+
+            m_waiters.fetch_add(1, std::memory_order_seq_cst);  // see store()
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), FUTEX_WAIT_PRIVATE, epoch,
+                    timeout, nullptr, 0);
+            m_waiters.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    void store_words(const T& value) {
+        uint64_t words[WORDS] = {};
+        memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; i++) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    alignas(64) std::atomic<uint64_t> m_seq{0};
+    std::atomic<uint64_t> m_words[WORDS];
+
+    // Futex word and waiter count live on their own line, away from the
+    // payload the readers spin on
+    alignas(64) mutable std::atomic<uint32_t> m_epoch{0};
+    mutable std::atomic<uint32_t> m_waiters{0};
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32-bit");
+};
+
+} // namespace RF
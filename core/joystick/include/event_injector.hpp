@@ -0,0 +1,109 @@
+#pragma once
+
+#include <linux/input.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <time.h>
+
+#include "async_log.hpp"
+
+namespace RF {
+
+// Stands in for /dev/input/eventN: a FIFO that a Joystick opens like any
+// device, and that this side fills with input_events, so the whole input
+// path (reader thread, mapping, frame commit, RFInterface) runs without a
+// radio.
+//
+//   EventInjector radio;               // creates the FIFO
+//   Joystick joystick(radio.path());
+//   radio.axis(ABS_X, 1500);
+//   radio.axis(ABS_Y, 300);
+//   radio.sync();                      // one frame, stamped now
+//
+// Events are held until sync(), which writes them and the SYN_REPORT in one
+// write() stamped with CLOCK_MONOTONIC, as the kernel delivers a packet.
+// Destroying the injector closes the FIFO: the Joystick sees end of input
+// and stops reading.
+class EventInjector {
+public:
+    static constexpr size_t MAX_EVENTS = 64;  // per frame
+
+    // nullptr: a fresh path under /tmp
+    explicit EventInjector(const char* path = nullptr) {
+        if (path) {
+            m_path = path;
+        } else {
+            static std::atomic<int> s_count{0};
+            m_path = "/tmp/seeker_js_" + std::to_string(getpid()) + "_" + std::to_string(s_count++);
+        }
+        unlink(m_path.c_str());
+        if (mkfifo(m_path.c_str(), 0600) != 0) {
+            RF_LOG_ERROR("EventInjector: mkfifo %s: %s", m_path.c_str(), strerror(errno));
+            return;
+        }
+        // Read-write so opening does not wait for the reader, and so the
+        // reader does not see end of input before the first frame
+        m_fd = open(m_path.c_str(), O_RDWR | O_NONBLOCK);
+    }
+
+    ~EventInjector() {
+        if (m_fd >= 0) close(m_fd);
+        unlink(m_path.c_str());
+    }
+
+    EventInjector(const EventInjector&) = delete;
+    EventInjector& operator=(const EventInjector&) = delete;
+
+    bool ok() const { return m_fd >= 0; }
+    const char* path() const { return m_path.c_str(); }
+
+    void axis(uint16_t code, int32_t value) { add(EV_ABS, code, value); }
+    void key(uint16_t code, bool pressed) { add(EV_KEY, code, pressed ? 1 : 0); }
+
+    // End the frame. Returns its stamp (steady clock ns), 0 if the write
+    // failed (e.g. the reader fell a pipe buffer behind).
+    int64_t sync() {
+        add(EV_SYN, SYN_REPORT, 0);
+
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        for (size_t i = 0; i < m_count; i++) {
+            m_events[i].input_event_sec = ts.tv_sec;
+            m_events[i].input_event_usec = ts.tv_nsec / 1000;
+        }
+
+        size_t bytes = m_count * sizeof(struct input_event);
+        ssize_t n = m_fd >= 0 ? write(m_fd, m_events, bytes) : -1;
+        m_count = 0;
+        if (n != static_cast<ssize_t>(bytes)) return 0;
+        m_frames++;
+        return int64_t(ts.tv_sec) * 1000000000LL + (ts.tv_nsec / 1000) * 1000;
+    }
+
+    uint64_t frames() const { return m_frames; }
+
+private:
+    void add(uint16_t type, uint16_t code, int32_t value) {
+        if (m_count == MAX_EVENTS - 1 && type != EV_SYN) return;  // keep room for the SYN_REPORT
+        struct input_event& ev = m_events[m_count++];
+        memset(&ev, 0, sizeof(ev));
+        ev.type = type;
+        ev.code = code;
+        ev.value = value;
+    }
+
+    std::string m_path;
+    int m_fd = -1;
+    struct input_event m_events[MAX_EVENTS];
+    size_t m_count = 0;
+    uint64_t m_frames = 0;
+};
+
+} // namespace RF
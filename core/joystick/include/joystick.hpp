@@ -10,8 +10,12 @@
 #include <memory>
 #include <thread>
 #include <atomic>
-#include <mutex>
 #include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "seqlock.hpp"
+#include "latency_histogram.hpp"
 
 namespace RF {
 
@@ -23,53 +27,154 @@ struct RFCmd {
     double rudder;
     double flaps;
     double gear;
+    int64_t event_time_ns = 0;  // steady clock time of the input event behind it, 0 if none
+};
+
+// Centered sticks, throttle off
+static constexpr RFCmd NEUTRAL_COMMAND = {0.0, 0.5, 0.5, 0.5, 0.0, 0.0};
+
+// What an axis or button drives
+enum class JoystickOutput : uint8_t {
+    Throttle,
+    Aileron,
+    Elevator,
+    Rudder,
+    Flaps,     // 3 detents: 0, 0.5, 1
+    Gear,      // 0 or 1
+    Disable,   // set: the sticks are out of the loop
+    Count
+};
+
+// Shaping of one axis. The device range (EVIOCGABS) is taken as [-1, 1]
+// around its center for the sticks, [0, 1] from its minimum for the rest.
+struct AxisCurve {
+    double deadzone = 0.0;  // fraction of travel at center (bottom for throttle) that reads as center
+    double expo = 0.0;      // 0 = linear, 1 = fully cubic
+    double trim = 0.0;      // offset added to the [0, 1] output
+    bool reversed = false;
+};
+
+struct AxisBinding {
+    uint16_t code;          // ABS_*
+    JoystickOutput output;
+    AxisCurve curve;
+};
+
+struct ButtonBinding {
+    uint16_t code;          // KEY_* / BTN_*
+    JoystickOutput output;
+    bool toggle;            // flip on each press; otherwise follow the button
+};
+
+// Which input drives which output
+struct JoystickMap {
+    std::vector<AxisBinding> axes;
+    std::vector<ButtonBinding> buttons;
+
+    // PocketMaster radio: sticks on codes 0-3, the 3-way switch on top left
+    // (code 5) for flaps, the first two buttons for gear and disable
+    static JoystickMap defaults();
 };
 
 
 class Joystick {
 public:
-    explicit Joystick(const char* device = "/dev/input/event0");
+    explicit Joystick(const char* device = "/dev/input/event0", const JoystickMap& map = JoystickMap::defaults());
     ~Joystick();
 
     bool start_reading();
     void stop_reading();
     bool is_reading();
     
-    // Called from other threads
+    // Called from other threads. Returns the last complete frame (all axis
+    // changes up to the latest SYN_REPORT), never a half-updated one. While
+    // the Disable output is set that is NEUTRAL_COMMAND, not the sticks.
     RF::RFCmd getJoystickVals();
 
+    // State of the Disable output in the last complete frame
+    bool isDisabled();
+
+    // Number of frames committed so far
+    uint64_t frameCount() const;
+
+    // Sleep until a frame newer than `after` is committed or timeout_ms
+    // passes (< 0 waits forever). Returns frameCount().
+    uint64_t waitForFrame(uint64_t after, int timeout_ms = -1) const;
+
+    // Kernel input event (SYN_REPORT) -> frame committed, for every frame
+    const LatencyHistogram& frameLatency() const { return m_frame_latency; }
+
+    // Apply one evdev event as the reader thread does: EV_ABS / EV_KEY update
+    // the pending frame, SYN_REPORT publishes it. Only while not reading
+    // (replaying recorded events, timing the mapping without a device).
+    void handleEvent(const struct input_event& ev);
+
 private:
+    static constexpr size_t NUM_OUTPUTS = static_cast<size_t>(JoystickOutput::Count);
+
+    struct Frame {
+        double value[NUM_OUTPUTS];
+        int64_t event_time_ns;  // SYN_REPORT that ended it, steady clock
+    };
+
+    // One bound axis: its device range and the output for every position
+    struct Axis {
+        AxisBinding binding;
+        int min = 0;
+        int shift = 0;            // raw positions per table entry = 1 << shift
+        std::vector<float> table;
+    };
+
     const char* CLASS = "JOYSTICK";
     const char* m_dev_path; 
     int m_fd = -1;
+    bool m_realtime_stamps = false;  // evdev without EVIOCSCLOCKID: stamps are CLOCK_REALTIME
+    int64_t m_realtime_offset_ns = 0;  // CLOCK_MONOTONIC - CLOCK_REALTIME, per read batch
 
     std::atomic_bool m_reading{false};
+    bool m_dropping = false;        // reader thread only: between SYN_DROPPED and the next SYN_REPORT
+
+    JoystickMap m_map;
+    std::vector<Axis> m_axes;
+    int8_t m_abs_slot[ABS_CNT];     // ABS code -> m_axes index, -1 = unbound
+    int8_t m_key_slot[KEY_CNT];     // key code -> m_map.buttons index, -1 = unbound
 
-    RFCmd m_state;
+    Frame m_pending{};              // reader thread only: frame being assembled
+    SeqLock<Frame> m_frame;         // last committed frame
+    int m_epoll_fd = -1;
+    int m_wake_fd = -1;             // eventfd, wakes the reader for stop_reading()
     std::thread m_joystick_read_thread;
-    std::mutex m_state_mutex;
+    LatencyHistogram m_frame_latency;
 
-    static constexpr float AXIS_MIN = 0.0f;
-    static constexpr float AXIS_MAX = 2040.0f;
-    static constexpr float AXIS_CENTER = (AXIS_MIN + AXIS_MAX) / 2.0f;
-    static constexpr float AXIS_RANGE = (AXIS_MAX - AXIS_CENTER);
+    static constexpr int EVENT_BATCH = 64;
+
+    // Used when the device does not report a range
+    static constexpr int DEFAULT_AXIS_MIN = 0;
+    static constexpr int DEFAULT_AXIS_MAX = 2040;
+    // Bigger ranges share entries
+    static constexpr int MAX_TABLE_SIZE = 4096;
 
     bool openDevice();
     bool closeDevice();
-    
-    // Map [0, 2047] to a toggle 
-    bool readJoystickDisable(float val);
-    
-    // Map [0, 2047] to [0, 1]
-    float normalize(float val);
-    
-    // Code# to control mapping:
-    //  Throttle: Code 2
-    //  Alieron/Roll: Code 0
-    //  Rudder/Yaw: Code 3
-    //  Elevator/Pitch:Code 1
-    //  Code 5: 3-way switch on top left
+
+    // Read each bound axis's range with EVIOCGABS and precompute its table
+    void calibrate();
+
+    // Output of `binding` at normalized position x ([0, 1] from the minimum)
+    static float shape(const AxisBinding& binding, double x);
+
+    // One table lookup per event
     void readAbs(int code, int value);
+    void readKey(int code, int value);
+
+    // Re-read every axis with EVIOCGABS (startup, and after SYN_DROPPED)
+    void syncAbs();
+
+    // Steady clock time of an event
+    int64_t eventTime(const struct input_event& ev) const;
+
+    // Publish m_pending as the current frame
+    void commitFrame();
     
     void pollForInputs();
 };
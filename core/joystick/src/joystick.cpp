@@ -1,19 +1,60 @@
 #include "joystick.hpp"
+#include "async_log.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <time.h>
 
 namespace RF {
 
-Joystick::Joystick(const char* device)
-    : m_dev_path(device)
+JoystickMap JoystickMap::defaults() {
+    JoystickMap map;
+    map.axes = {
+        {ABS_X, JoystickOutput::Aileron, {}},   // code 0
+        {ABS_Y, JoystickOutput::Elevator, {}},  // code 1
+        {ABS_Z, JoystickOutput::Throttle, {}},  // code 2
+        {ABS_RX, JoystickOutput::Rudder, {}},   // code 3
+        {ABS_RZ, JoystickOutput::Flaps, {}},    // code 5: 3-way switch
+    };
+    map.buttons = {
+        {BTN_TRIGGER, JoystickOutput::Gear, false},
+        {BTN_THUMB, JoystickOutput::Disable, false},
+    };
+    return map;
+}
+
+Joystick::Joystick(const char* device, const JoystickMap& map)
+    : m_dev_path(device), m_map(map)
 {
-    if (openDevice()) {
-        std::cout << "[SUCCESS] Joystick: Successfully opened device: " << m_dev_path << std::endl;
+    memset(m_key_slot, -1, sizeof(m_key_slot));
+    for (size_t i = 0; i < m_map.buttons.size() && i < INT8_MAX; i++) {
+        if (m_map.buttons[i].code < KEY_CNT && m_map.buttons[i].output < JoystickOutput::Count) {
+            m_key_slot[m_map.buttons[i].code] = static_cast<int8_t>(i);
+        }
+    }
+
+    // Sticks centered until the device says otherwise
+    m_pending.value[static_cast<size_t>(JoystickOutput::Aileron)] = 0.5;
+    m_pending.value[static_cast<size_t>(JoystickOutput::Elevator)] = 0.5;
+    m_pending.value[static_cast<size_t>(JoystickOutput::Rudder)] = 0.5;
+
+    bool opened = openDevice();
+    calibrate();  // device ranges if it opened, the defaults otherwise
+    if (opened) {
+        RF_LOG_SUCCESS("Joystick: Successfully opened device: %s", m_dev_path);
         if(start_reading()) {
-            std::cout << "[SUCCESS] Joystick: Started Reading from " << m_dev_path << std::endl;
+            RF_LOG_SUCCESS("Joystick: Started Reading from %s", m_dev_path);
         }
     }
 }
 
 Joystick::~Joystick() {
+    stop_reading();
     if (m_joystick_read_thread.joinable()) {
         m_joystick_read_thread.join();
     }
@@ -22,6 +63,12 @@ Joystick::~Joystick() {
 
 bool Joystick::start_reading() {
     if(m_fd > 0) {
+        // Clear a wake-up left over from a previous stop_reading()
+        uint64_t count;
+        while (read(m_wake_fd, &count, sizeof(count)) > 0) {}
+
+        m_pending.event_time_ns = 0;  // not from an event
+        syncAbs();
         m_reading.store(true);
         m_joystick_read_thread = std::thread(&Joystick::pollForInputs, this);
         return true;
@@ -31,6 +78,13 @@ bool Joystick::start_reading() {
 
 void Joystick::stop_reading() {
     if(m_reading) m_reading.store(false);
+
+    // Kick the reader out of epoll_wait
+    if (m_wake_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(m_wake_fd, &one, sizeof(one));
+        (void)n;
+    }
 }
 
 bool Joystick::is_reading() {
@@ -38,90 +92,275 @@ bool Joystick::is_reading() {
 }
 
 RF::RFCmd Joystick::getJoystickVals() {
-    std::lock_guard<std::mutex> lock(m_state_mutex);
-    RFCmd new_state = m_state;
-    return new_state;
+    Frame frame;
+    m_frame.load(frame);
+    const double* v = frame.value;
+    if (v[static_cast<size_t>(JoystickOutput::Disable)] >= 0.5) {
+        RFCmd neutral = NEUTRAL_COMMAND;
+        neutral.event_time_ns = frame.event_time_ns;
+        return neutral;
+    }
+    return RFCmd{v[static_cast<size_t>(JoystickOutput::Throttle)], v[static_cast<size_t>(JoystickOutput::Aileron)],
+                 v[static_cast<size_t>(JoystickOutput::Elevator)], v[static_cast<size_t>(JoystickOutput::Rudder)],
+                 v[static_cast<size_t>(JoystickOutput::Flaps)], v[static_cast<size_t>(JoystickOutput::Gear)],
+                 frame.event_time_ns};
+}
+
+bool Joystick::isDisabled() {
+    Frame frame;
+    m_frame.load(frame);
+    return frame.value[static_cast<size_t>(JoystickOutput::Disable)] >= 0.5;
+}
+
+uint64_t Joystick::frameCount() const {
+    return m_frame.version();
+}
+
+uint64_t Joystick::waitForFrame(uint64_t after, int timeout_ms) const {
+    return m_frame.wait_for_update(after, timeout_ms);
 }
 
 bool Joystick::openDevice() {
     m_fd = open(m_dev_path, O_RDONLY | O_NONBLOCK);
     if(m_fd < 0) {
-        std::cerr << "[ERROR] Joystick: Failed to open " << m_dev_path << ": "
-                  << strerror(errno) << "\n";
+        RF_LOG_ERROR("Joystick: Failed to open %s: %s", m_dev_path, strerror(errno));
         return false;
     }
+
+    // Event stamps on the steady clock, like everything they are compared
+    // with. Evdev devices too old for that stamp with CLOCK_REALTIME;
+    // anything else (a FIFO fed by EventInjector) is expected to use
+    // CLOCK_MONOTONIC already.
+    int clock_id = CLOCK_MONOTONIC;
+    struct stat st;
+    m_realtime_stamps = ioctl(m_fd, EVIOCSCLOCKID, &clock_id) != 0 && fstat(m_fd, &st) == 0 && S_ISCHR(st.st_mode);
+
+    // The reader blocks in epoll on the device and the wake eventfd, so
+    // events are picked up as soon as the kernel queues them
+    m_epoll_fd = epoll_create1(0);
+    m_wake_fd = eventfd(0, EFD_NONBLOCK);
+    if (m_epoll_fd < 0 || m_wake_fd < 0) {
+        RF_LOG_ERROR("Joystick: epoll setup failed: %s", strerror(errno));
+        closeDevice();
+        return false;
+    }
+
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = m_fd;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_fd, &ev);
+    ev.data.fd = m_wake_fd;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &ev);
     return true;
 }
 
 bool Joystick::closeDevice() {
     if(m_fd >= 0) close(m_fd);
+    if(m_epoll_fd >= 0) close(m_epoll_fd);
+    if(m_wake_fd >= 0) close(m_wake_fd);
     m_fd = -1;
+    m_epoll_fd = -1;
+    m_wake_fd = -1;
     return true;
 }
 
-bool Joystick::readJoystickDisable(float val) {
-    return (val == 0);
-}
+void Joystick::calibrate() {
+    m_axes.clear();
+    memset(m_abs_slot, -1, sizeof(m_abs_slot));
+
+    for (const AxisBinding& binding : m_map.axes) {
+        if (binding.code >= ABS_CNT || binding.output >= JoystickOutput::Count || m_axes.size() >= INT8_MAX) {
+            continue;
+        }
 
-float Joystick::normalize(float val) {
-    if (val < AXIS_MIN) val = AXIS_MIN;
-    if (val > AXIS_MAX) val = AXIS_MAX;
-    return (val - AXIS_MIN) / (AXIS_MAX - AXIS_MIN);
+        Axis axis;
+        axis.binding = binding;
+        AxisCurve& curve = axis.binding.curve;
+        int min = DEFAULT_AXIS_MIN;
+        int max = DEFAULT_AXIS_MAX;
+        struct input_absinfo info;
+        if (m_fd >= 0 && ioctl(m_fd, EVIOCGABS(binding.code), &info) == 0 && info.maximum > info.minimum) {
+            min = info.minimum;
+            max = info.maximum;
+            // The device's own flat zone around center, if wider than ours
+            if (info.flat > 0) curve.deadzone = std::max(curve.deadzone, 2.0 * info.flat / (double(max) - min));
+            RF_LOG_DEBUG("Joystick: axis %d range [%d, %d], flat %d", binding.code, min, max, info.flat);
+        }
+        curve.deadzone = std::min(std::max(curve.deadzone, 0.0), 0.95);
+        curve.expo = std::min(std::max(curve.expo, 0.0), 1.0);
+
+        // One entry per position, or per 2^shift positions for wide ranges
+        int64_t span = int64_t(max) - min;
+        while ((span >> axis.shift) + 1 > MAX_TABLE_SIZE) axis.shift++;
+        axis.min = min;
+        axis.table.resize(static_cast<size_t>(span >> axis.shift) + 1);
+        for (size_t i = 0; i < axis.table.size(); i++) {
+            int64_t offset = std::min<int64_t>(int64_t(i) << axis.shift, span);
+            axis.table[i] = shape(axis.binding, double(offset) / span);
+        }
+
+        m_abs_slot[binding.code] = static_cast<int8_t>(m_axes.size());
+        m_axes.push_back(std::move(axis));
+    }
 }
 
-void Joystick::readAbs(int code, int value) {
-    std::lock_guard<std::mutex> lock(m_state_mutex);
-    switch (code) {
-        case 0:
-            m_state.aileron = normalize(value);
+float Joystick::shape(const AxisBinding& binding, double x) {
+    const AxisCurve& curve = binding.curve;
+    if (curve.reversed) x = 1.0 - x;
+
+    auto expo = [&](double m) { return (1.0 - curve.expo) * m + curve.expo * m * m * m; };
+    auto dead = [&](double m) { return m <= curve.deadzone ? 0.0 : (m - curve.deadzone) / (1.0 - curve.deadzone); };
+
+    double out = 0.0;
+    switch (binding.output) {
+        case JoystickOutput::Aileron:
+        case JoystickOutput::Elevator:
+        case JoystickOutput::Rudder: {
+            double s = 2.0 * x - 1.0;
+            out = 0.5 + 0.5 * std::copysign(expo(dead(std::fabs(s))), s) + curve.trim;
             break;
-        case 1:
-            m_state.elevator = normalize(value);
+        }
+        case JoystickOutput::Throttle:
+            out = expo(dead(x)) + curve.trim;
             break;
-        case 2:
-            m_state.throttle = normalize(value);
+        case JoystickOutput::Flaps:
+            out = std::round(x * 2.0) / 2.0;
             break;
-        case 3:
-            m_state.rudder = normalize(value);
+        case JoystickOutput::Gear:
+            out = x >= 0.5 ? 1.0 : 0.0;
             break;
-        case 5:
-            // TODO: pass this disable to RFInterface
-            readJoystickDisable(value);
+        case JoystickOutput::Disable:
+            out = x < 0.25 ? 1.0 : 0.0;  // switch down
             break;
+        default:
+            break;
+    }
+    return static_cast<float>(std::min(std::max(out, 0.0), 1.0));
+}
+
+void Joystick::readAbs(int code, int value) {
+    if (code < 0 || code >= ABS_CNT || m_abs_slot[code] < 0) return;
+    const Axis& axis = m_axes[m_abs_slot[code]];
+
+    int64_t offset = int64_t(value) - axis.min;
+    size_t i = offset <= 0 ? 0 : std::min(static_cast<size_t>(offset >> axis.shift), axis.table.size() - 1);
+    m_pending.value[static_cast<size_t>(axis.binding.output)] = axis.table[i];
+}
+
+void Joystick::readKey(int code, int value) {
+    if (code < 0 || code >= KEY_CNT || m_key_slot[code] < 0 || value == 2) return;  // 2: autorepeat
+    const ButtonBinding& button = m_map.buttons[m_key_slot[code]];
+
+    double& out = m_pending.value[static_cast<size_t>(button.output)];
+    if (!button.toggle) {
+        out = value ? 1.0 : 0.0;
+    } else if (value) {
+        out = out >= 0.5 ? 0.0 : 1.0;
+    }
+}
+
+void Joystick::syncAbs() {
+    for (const Axis& axis : m_axes) {
+        struct input_absinfo info;
+        if (ioctl(m_fd, EVIOCGABS(axis.binding.code), &info) == 0) {
+            readAbs(axis.binding.code, info.value);
+        }
+    }
+
+    // Buttons that follow their state; toggles keep theirs
+    uint8_t keys[KEY_CNT / 8 + 1] = {};
+    if (ioctl(m_fd, EVIOCGKEY(sizeof(keys)), keys) >= 0) {
+        for (const ButtonBinding& button : m_map.buttons) {
+            if (!button.toggle && button.code < KEY_CNT) {
+                readKey(button.code, (keys[button.code / 8] >> (button.code % 8)) & 1);
+            }
+        }
+    }
+    commitFrame();
+}
+
+int64_t Joystick::eventTime(const struct input_event& ev) const {
+    int64_t ns = int64_t(ev.input_event_sec) * 1000000000LL + int64_t(ev.input_event_usec) * 1000;
+    return m_realtime_stamps ? ns + m_realtime_offset_ns : ns;
+}
+
+void Joystick::commitFrame() {
+    m_frame.store(m_pending);
+    if (m_pending.event_time_ns != 0) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t age = int64_t(now.tv_sec) * 1000000000LL + now.tv_nsec - m_pending.event_time_ns;
+        m_frame_latency.record(age > 0 ? static_cast<uint64_t>(age) : 0);
+    }
+}
+
+void Joystick::handleEvent(const struct input_event& ev) {
+    if (ev.type == EV_SYN && ev.code == SYN_DROPPED) {
+        // Kernel buffer overflowed: events were lost, so the
+        // partial frame is garbage until the next SYN_REPORT
+        m_dropping = true;
+    } else if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+        m_pending.event_time_ns = eventTime(ev);
+        if (m_dropping) {
+            m_dropping = false;
+            syncAbs();
+        } else {
+            commitFrame();
+        }
+    } else if (ev.type == EV_ABS && !m_dropping) {
+        readAbs(ev.code, ev.value);
+    } else if (ev.type == EV_KEY && !m_dropping) {
+        readKey(ev.code, ev.value);
     }
 }
 
 void Joystick::pollForInputs() {
-    std::cout << "[INFO] Joystick polling thread started" << std::endl;
+    RF_LOG_INFO("Joystick polling thread started");
+
+    struct input_event events[EVENT_BATCH];
+    struct epoll_event ready[2];
+    m_dropping = false;
     
     while(m_reading.load()) {
-        if (m_fd < 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            continue;
+        int nready = epoll_wait(m_epoll_fd, ready, 2, -1);
+        if (nready < 0) {
+            if (errno == EINTR) continue;
+            RF_LOG_ERROR("Joystick epoll_wait failed: %s", strerror(errno));
+            break;
         }
 
-        struct input_event ev;
-        ssize_t n = read(m_fd, &ev, sizeof(ev));
-        
-        if (n < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // No data ready, wait a bit
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                continue;
-            } else {
-                std::cerr << "[ERROR] Joystick read failed: " << strerror(errno) << std::endl;
+        // Drain everything queued, a batch of events per read()
+        while (m_reading.load()) {
+            ssize_t n = read(m_fd, events, sizeof(events));
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                if (errno == EINTR) continue;
+                RF_LOG_ERROR("Joystick read failed: %s", strerror(errno));
+                m_reading.store(false);
                 break;
             }
-        }
-        
-        if (n == sizeof(ev)) {
-            if (ev.type == EV_ABS) {
-                readAbs(ev.code, ev.value);
+            if (n == 0) {
+                // Writer gone (FIFO): nothing more will come
+                RF_LOG_INFO("Joystick: end of input on %s", m_dev_path);
+                m_reading.store(false);
+                break;
+            }
+
+            if (m_realtime_stamps) {
+                struct timespec mono, real;
+                clock_gettime(CLOCK_MONOTONIC, &mono);
+                clock_gettime(CLOCK_REALTIME, &real);
+                m_realtime_offset_ns = (int64_t(mono.tv_sec) - real.tv_sec) * 1000000000LL + mono.tv_nsec - real.tv_nsec;
+            }
+
+            size_t count = n / sizeof(struct input_event);
+            for (size_t i = 0; i < count; i++) {
+                handleEvent(events[i]);
             }
         }
     }
     
-    std::cout << "[INFO] Joystick polling thread exiting" << std::endl;
+    RF_LOG_INFO("Joystick polling thread exiting");
 }
 
 } // namespace RF
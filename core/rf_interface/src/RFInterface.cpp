@@ -7,61 +7,97 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <errno.h>
-#include <sys/select.h>
+#include <poll.h>
 
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include <iostream>
 #include <sstream>
 
 #include "RFInterface.hpp"
-#include "joystick.hpp"
 
 namespace RF {
 
-// Static socket pool
-static SocketPool* g_socket_pool = nullptr;
+static_assert(sizeof(AircraftState) <= FlightRecord::MAX_PAYLOAD, "AircraftState does not fit a FlightRecord");
 
-RFInterface::RFInterface(const char* rf_ip, uint16_t rf_port) 
+RFInterface::RFInterface(const char* rf_ip, uint16_t rf_port, bool auto_start,
+                         std::shared_ptr<LinkReactor> reactor)
     : rf_server_ip(rf_ip),
       rf_server_port(rf_port),
+      m_reactor(reactor ? std::move(reactor) : LinkReactor::shared()),
       sock_fd(-1),
-      m_connected(false),
-      m_joystick("/dev/input/event0") 
+      m_connected(false)
 {
     memset(&state, 0, sizeof(state));
-    memset(reply_buffer, 0, sizeof(reply_buffer));
-    
-    bool init_ok = false;
+    m_response.reserve(HttpResponse::INITIAL_CAPACITY);
 
-    // Initialize socket pool (pool size of 3 sockets)
-    if (!g_socket_pool) {
-        g_socket_pool = new SocketPool(rf_ip, rf_port, 3);
-    }
+    // Socket pool for this endpoint (pool size of 3 sockets)
+    m_socket_pool = std::make_unique<SocketPool>(rf_ip, rf_port, 3, m_reactor);
 
-    init_ok = (g_socket_pool == nullptr) ? false : true;
-        
-    if(init_ok &= connect()) {
-        std::cout << "RFInterface initialized for " << rf_ip << ":" << rf_port << std::endl;
+    if (auto_start) {
+        if (start()) {
+            RF_LOG_SUCCESS("RFInterface Connected Successfully");
+        } else {
+            RF_LOG_ERROR("RFInterface Initialization Failed");
+        }
     }
+}
 
-    // while(!m_joystick.is_reading()) {
-    //     // std::cout << "[UPDATE] RFInterface Waiting on Joystick to begin reading" << std::endl;
-    //     // std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    // }
 
-    if (init_ok) {
-        m_update_thread = std::thread(&RFInterface::update, this);
-        std::cout << "[SUCCESS] RFInterface Connected Successfully" <<  std::endl;
+RFInterface::~RFInterface() {
+    stop();
+    if (m_connected) disconnect();
+}
+
+
+bool RFInterface::start() {
+    if (m_running.load()) return true;
+    if (!m_reactor->ok()) return false;
+
+    if (!m_connected && !connect()) {
+        return false;
+    }
+    RF_LOG_INFO("RFInterface initialized for %s:%u", rf_server_ip, rf_server_port);
+
+    m_running.store(true);
+    if (m_reactor_mode) {
+        m_scheduler.start();
+        m_in_flight.clear();
+        m_in_flight.resize(m_pipeline_depth);
+        for (auto& slot : m_in_flight) {
+            slot.response.reserve(HttpResponse::INITIAL_CAPACITY);
+        }
+        m_reactor->attach(this);
     } else {
-        std::cout << "[ERROR] RFInterface Initialization Failed" <<  std::endl;
+        m_update_thread = std::thread(&RFInterface::update, this);
+    }
+    if (m_report_period_s > 0) {
+        m_report_thread = std::thread(&RFInterface::report_latency, this);
     }
+    return true;
 }
 
 
-RFInterface::~RFInterface() {
-    disconnect();
-    m_joystick.stop_reading();
+void RFInterface::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_report_mutex);
+        m_running.store(false);
+    }
+    m_report_cv.notify_all();
+    if (m_update_thread.joinable()) {
+        m_update_thread.join();
+    }
+    if (m_reactor_mode) {
+        m_reactor->detach(this);
+        for (auto& slot : m_in_flight) {
+            if (slot.fd >= 0) close(slot.fd);
+            slot.fd = -1;
+        }
+    }
+    if (m_report_thread.joinable()) {
+        m_report_thread.join();
+    }
 }
 
 bool RFInterface::isRFConnected() {
@@ -69,9 +105,155 @@ bool RFInterface::isRFConnected() {
 }
 
 
+void RFInterface::set_pipeline_depth(size_t depth) {
+    m_pipeline_depth = std::max<size_t>(depth, 1);
+
+    // Enough pre-connected sockets for every slot plus one being refilled
+    m_socket_pool->set_pool_size(std::max<size_t>(3, m_pipeline_depth + 1));
+}
+
+
+void RFInterface::set_scheduler(const SchedulerConfig& config) {
+    m_scheduler.configure(config);
+}
+
+
+void RFInterface::set_command_source(std::unique_ptr<CommandSource> source) {
+    m_owned_source = std::move(source);
+    m_source = m_owned_source ? m_owned_source.get() : &m_external;
+}
+
+
+RFCmd RFInterface::next_command() {
+    TimedCommand next = m_source->latest();
+    if (next.stamp_ns != 0) {
+        int64_t age = command_clock_ns() - next.stamp_ns;
+        m_latency.record_ns(ExchangeStage::CommandAge, age > 0 ? static_cast<uint64_t>(age) : 0);
+    }
+    return next.cmd;
+}
+
+
+bool RFInterface::set_io_uring(bool on) {
+    if (!on) {
+        m_uring.close();
+        return true;
+    }
+
+    struct sockaddr_in server;
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_port = htons(rf_server_port);
+    if (inet_pton(AF_INET, rf_server_ip, &server.sin_addr) <= 0) {
+        RF_LOG_ERROR("RFInterface: Invalid address: %s", rf_server_ip);
+        return false;
+    }
+    if (!m_uring_buffer) m_uring_buffer.reset(new char[URING_BUFFER_SIZE]);
+    return m_uring.open(server, m_uring_buffer.get(), URING_BUFFER_SIZE);
+}
+
+
+void RFInterface::set_latency_report(double period_s, FILE* out) {
+    m_report_period_s = std::max(period_s, 0.0);
+    m_report_out = out;
+}
+
+
+// " name p50/p99" for each stage in [first, last] with samples; false if none
+static bool format_latency(const ExchangeLatency& latency, ExchangeStage first, ExchangeStage last,
+                           char* buf, size_t size) {
+    size_t used = 0;
+    buf[0] = '\0';
+    for (int i = static_cast<int>(first); i <= static_cast<int>(last) && used < size; i++) {
+        ExchangeStage stage = static_cast<ExchangeStage>(i);
+        LatencySummary s = latency.summary(stage);
+        if (s.count == 0) continue;
+        int n = snprintf(buf + used, size - used, " %s %.1f/%.1f", stage_name(stage), s.p50_us, s.p99_us);
+        if (n > 0) used += static_cast<size_t>(n);
+    }
+    return used > 0;
+}
+
+
+void RFInterface::report_latency() {
+    auto period = duration_cast<steady_clock::duration>(duration<double>(m_report_period_s));
+    std::unique_lock<std::mutex> lock(m_report_mutex);
+    while (!m_report_cv.wait_for(lock, period, [this] { return !m_running.load(); })) {
+        if (m_report_out) {
+            fprintf(m_report_out, "RFInterface exchange latency:\n");
+            m_latency.print(m_report_out);
+            fflush(m_report_out);
+            continue;
+        }
+
+        // Two lines, each within a log record
+        char text[192];
+        if (format_latency(m_latency, ExchangeStage::SocketAcquire, ExchangeStage::Parse, text, sizeof(text))) {
+            RF_LOG_INFO("Exchange latency p50/p99 us:%s", text);
+        }
+        if (format_latency(m_latency, ExchangeStage::CommandAge, ExchangeStage::InputToState, text, sizeof(text))) {
+            RF_LOG_INFO("Command latency p50/p99 us:%s", text);
+        }
+    }
+}
+
+
+bool RFInterface::start_recording(const char* path, size_t capacity) {
+    return m_recorder.open(path, capacity, sizeof(RFCmd), sizeof(AircraftState));
+}
+
+
+void RFInterface::stop_recording() {
+    m_recorder.close();
+}
+
+
+bool RFInterface::start_capture(const char* path) {
+    return m_capture.open(path);
+}
+
+
+void RFInterface::stop_capture() {
+    m_capture.close();
+}
+
+
+void RFInterface::record_command(const struct RFCmd &input) {
+    if (!m_recorder.is_open()) return;
+    int64_t now = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    m_recorder.record(RECORD_CMD, m_frames.load(std::memory_order_relaxed), now, &input, sizeof(input));
+}
+
+
+// The first request to carry input event `event_ns` records its age at
+// send. Returns event_ns if it is to be traced on to the state, else 0.
+int64_t RFInterface::trace_input_send(int64_t event_ns) {
+    if (event_ns == 0 || event_ns == m_traced_input_ns) return 0;
+    m_traced_input_ns = event_ns;
+    int64_t age = command_clock_ns() - event_ns;
+    m_latency.record_ns(ExchangeStage::InputToSend, age > 0 ? static_cast<uint64_t>(age) : 0);
+    return event_ns;
+}
+
+
+void RFInterface::trace_input_state(int64_t event_ns) {
+    if (event_ns == 0) return;
+    int64_t age = command_clock_ns() - event_ns;
+    m_latency.record_ns(ExchangeStage::InputToState, age > 0 ? static_cast<uint64_t>(age) : 0);
+}
+
+
 void RFInterface::update() {
-    while(m_connected) {
-        RFCmd cmd = m_joystick.getJoystickVals();
+    m_scheduler.apply_realtime();
+    m_scheduler.start();
+
+    if (m_pipeline_depth > 1) {
+        update_pipelined();
+        return;
+    }
+
+    while(m_running.load() && m_connected) {
+        RFCmd cmd = next_command();
         // std::cout << "\n\n===========\n" << 
         // "Joy Command:\n" <<  
         // "Aileron: " << cmd.aileron << "\n" <<
@@ -82,8 +264,8 @@ void RFInterface::update() {
 
         exchange_data(cmd);
 
-        // Works better without sleep
-        // std::this_thread::sleep_for(10ms);
+        // Free-running unless a rate is configured
+        m_scheduler.wait_next();
     }
 }
 
@@ -92,24 +274,24 @@ bool RFInterface::connect() {
     // Inject the UAV controller interface to take over from the internal RC
     const char* empty_body = "";
     if (!soap_request_start("InjectUAVControllerInterface", empty_body)) {
-        std::cerr << "Failed to send InjectUAVControllerInterface request" << std::endl;
+        RF_LOG_ERROR("Failed to send InjectUAVControllerInterface request");
         return false;
     }
     
-    char* response = soap_request_end(1000);
-    if (!response) {
-        std::cerr << "Failed to receive InjectUAVControllerInterface response" << std::endl;
+    ReplyView reply;
+    if (!soap_request_end(1000, reply)) {
+        RF_LOG_ERROR("Failed to receive InjectUAVControllerInterface response");
         return false;
     }
     
     // Check if response indicates success (200 status)
-    if (strstr(response, "200 OK") != nullptr) {
-        std::cout << "External control enabled (RealFlight Link active)" << std::endl;
+    if (reply.status == 200) {
+        RF_LOG_INFO("External control enabled (RealFlight Link active)");
         m_connected = true;
         return true;
     }
     
-    std::cerr << "InjectUAVControllerInterface request failed" << std::endl;
+    RF_LOG_ERROR("InjectUAVControllerInterface request failed");
     return false;
 }
 
@@ -118,24 +300,24 @@ bool RFInterface::disconnect() {
     // Restore the original controller device (joystick/RC)
     const char* empty_body = "";
     if (!soap_request_start("RestoreOriginalControllerDevice", empty_body)) {
-        std::cerr << "Failed to send RestoreOriginalControllerDevice request" << std::endl;
+        RF_LOG_ERROR("Failed to send RestoreOriginalControllerDevice request");
         return false;
     }
     
-    char* response = soap_request_end(1000);
-    if (!response) {
-        std::cerr << "Failed to receive RestoreOriginalControllerDevice response" << std::endl;
+    ReplyView reply;
+    if (!soap_request_end(1000, reply)) {
+        RF_LOG_ERROR("Failed to receive RestoreOriginalControllerDevice response");
         return false;
     }
     
     // Check if response indicates success (200 status)
-    if (strstr(response, "200 OK") != nullptr) {
-        std::cout << "External control disabled (internal RC/joystick active)" << std::endl;
+    if (reply.status == 200) {
+        RF_LOG_INFO("External control disabled (internal RC/joystick active)");
         m_connected = false;
         return true;
     }
     
-    std::cerr << "RestoreOriginalControllerDevice request failed" << std::endl;
+    RF_LOG_ERROR("RestoreOriginalControllerDevice request failed");
     return false;
 }
 
@@ -145,35 +327,28 @@ bool RFInterface::reset_aircraft() {
     // Reset aircraft position (equivalent to pressing spacebar in RealFlight)
     const char* empty_body = "";
     if (!soap_request_start("ResetAircraft", empty_body)) {
-        std::cerr << "Failed to send ResetAircraft request" << std::endl;
+        RF_LOG_ERROR("Failed to send ResetAircraft request");
         return false;
     }
     
-    char* response = soap_request_end(1000);
-    if (!response) {
-        std::cerr << "Failed to receive ResetAircraft response" << std::endl;
+    ReplyView reply;
+    if (!soap_request_end(1000, reply)) {
+        RF_LOG_ERROR("Failed to receive ResetAircraft response");
         return false;
     }
     
     // Check if response indicates success (200 status)
-    if (strstr(response, "200 OK") != nullptr) {
-        std::cout << "Aircraft reset to initial position" << std::endl;
+    if (reply.status == 200) {
+        RF_LOG_INFO("Aircraft reset to initial position");
         return true;
     }
     
-    std::cerr << "ResetAircraft request failed" << std::endl;
+    RF_LOG_ERROR("ResetAircraft request failed");
     return false;
 }
 
 
 bool RFInterface::soap_request_start(const char *action, const char *fmt, ...) {
-    // Get socket from pool
-    sock_fd = g_socket_pool->get_socket();
-    if (sock_fd < 0) {
-        std::cerr << "Failed to get socket from pool" << std::endl;
-        return false;
-    }
-    
     // Build the SOAP body
     char body[1024];
     if (fmt && strlen(fmt) > 0) {
@@ -209,85 +384,125 @@ bool RFInterface::soap_request_start(const char *action, const char *fmt, ...) {
     
     std::string request_str = request.str();
     
+    return soap_send(request_str.c_str(), request_str.length());
+}
+
+
+bool RFInterface::soap_send(const char *request, size_t len) {
+    // Get socket from pool
+    auto t0 = steady_clock::now();
+    sock_fd = m_socket_pool->get_socket(SOCKET_WAIT_MS);
+    auto t1 = steady_clock::now();
+    m_latency.record(ExchangeStage::SocketAcquire, t0, t1);
+    if (sock_fd < 0) {
+        RF_LOG_ERROR("Failed to get socket from pool");
+        return false;
+    }
+
     // Send request
-    ssize_t sent = send(sock_fd, request_str.c_str(), request_str.length(), 0);
+    ssize_t sent = send(sock_fd, request, len, 0);
     if (sent < 0) {
-        std::cerr << "Failed to send SOAP request: " << strerror(errno) << std::endl;
+        RF_LOG_ERROR("Failed to send SOAP request: %s", strerror(errno));
         close(sock_fd);
         sock_fd = -1;
         return false;
     }
-    
+    m_sent_at = steady_clock::now();
+    m_latency.record(ExchangeStage::Send, t1, m_sent_at);
+    m_capture_id = m_capture.request(request, len);
+
     return true;
 }
 
 
-char* RFInterface::soap_request_end(uint32_t timeout_ms) {
+bool RFInterface::soap_request_end(uint32_t timeout_ms, ReplyView &reply) {
     if (sock_fd < 0) {
-        return nullptr;
-    }
-    
-    memset(reply_buffer, 0, sizeof(reply_buffer));
-    
-    // Read response with timeout
-    fd_set readfds;
-    struct timeval tv;
-    
-    FD_ZERO(&readfds);
-    FD_SET(sock_fd, &readfds);
-    
-    tv.tv_sec = timeout_ms / 1000;
-    tv.tv_usec = (timeout_ms % 1000) * 1000;
-    
-    int ready = select(sock_fd + 1, &readfds, nullptr, nullptr, &tv);
-    if (ready <= 0) {
-        std::cerr << "Timeout or error waiting for response" << std::endl;
-        close(sock_fd);
-        sock_fd = -1;
-        return nullptr;
+        return false;
     }
     
-    // Read response
-    size_t total_received = 0;
-    ssize_t n;
-    
-    while (total_received < sizeof(reply_buffer) - 1) {
-        n = recv(sock_fd, reply_buffer + total_received, sizeof(reply_buffer) - total_received - 1, 0);
-        
-        if (n <= 0) {
-            break;
+    // Read the response incrementally: the parser picks up the status line
+    // and Content-Length once, then exactly the body is read
+    m_response.reset();
+    auto deadline = m_sent_at + milliseconds(timeout_ms);
+    bool readable = false;  // nothing is there yet right after the send
+    while (!m_response.complete() && !m_response.failed()) {
+        if (!readable) {
+            int left = static_cast<int>(ceil<milliseconds>(deadline - steady_clock::now()).count());
+            struct pollfd pfd = {sock_fd, POLLIN, 0};
+            if (left <= 0 || poll(&pfd, 1, left) <= 0) {
+                RF_LOG_ERROR("Timeout or error waiting for response");
+                m_response.fail();
+                break;
+            }
+            readable = true;
         }
-        
-        total_received += n;
-        
-        // Check if we've received the complete response
-        if (strstr(reply_buffer, "</SOAP-ENV:Envelope>") != nullptr) {
+
+        size_t space;
+        char *dst = m_response.space(space);
+        if (!dst) {
+            RF_LOG_ERROR("Response larger than %zu bytes", HttpResponse::MAX_SIZE);
+            m_response.fail();
             break;
         }
+
+        ssize_t n = recv(sock_fd, dst, space, MSG_DONTWAIT);
+        if (n > 0) {
+            if (m_response.size() == 0) {
+                m_latency.record(ExchangeStage::FirstByte, m_sent_at, steady_clock::now());
+            }
+            m_response.commit(n);
+        } else if (n == 0) {
+            m_response.finish();
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            readable = false;
+        } else {
+            RF_LOG_ERROR("Failed to receive response: %s", strerror(errno));
+            m_response.fail();
+        }
     }
     
     // Close socket (don't return to pool. RealFlight requires new connection per request)
     close(sock_fd);
     sock_fd = -1;
+    m_latency.record(ExchangeStage::Receive, m_sent_at, steady_clock::now());
+    m_capture.response(m_capture_id, m_response.data(), m_response.size());
     
-    if (total_received > 0) {
-        reply_buffer[total_received] = '\0';
-        return reply_buffer;
+    if (!m_response.complete()) {
+        if (m_response.size() > 0) {
+            RF_LOG_ERROR("Incomplete response (%zu bytes)", m_response.size());
+        }
+        return false;
     }
-    
-    return nullptr;
+    reply.status = m_response.status();
+    reply.body = m_response.body();
+    reply.body_size = m_response.body_size();
+    return true;
 }
 
 
-void RFInterface::exchange_data(const struct RFCmd &input) {
-    // Build control inputs XML
-    std::stringstream body;
-    body << "<pControlInputs>"
-         << "<m-selectedChannels>4095</m-selectedChannels>"
-         << "<m-channelValues-0to1>";
-    
+bool RFInterface::uring_request(const char *request, size_t len, uint32_t timeout_ms, ReplyView &reply) {
+    uint64_t capture_id = m_capture.request(request, len);
+    auto t0 = steady_clock::now();
+    steady_clock::time_point first_byte;
+    ssize_t n = m_uring.exchange(request, len, m_uring_framing, timeout_ms, &first_byte);
+    auto t1 = steady_clock::now();
+
+    m_capture.response(capture_id, m_uring_buffer.get(), n > 0 ? static_cast<size_t>(n) : 0);
+    if (n <= 0) return false;
+
+    // Submission to first byte / full reply: connect and send included
+    m_latency.record(ExchangeStage::FirstByte, t0, first_byte);
+    m_latency.record(ExchangeStage::Receive, t0, t1);
+    reply.status = m_uring_framing.status();
+    reply.body = m_uring_buffer.get() + m_uring_framing.header_size();
+    reply.body_size = m_uring_framing.content_length();
+    return true;
+}
+
+
+void RFInterface::fill_request(const struct RFCmd &input) {
     // Map control inputs to channels (0.0 to 1.0 range)
-    double channels[12] = {
+    double channels[ExchangeRequest::NUM_CHANNELS] = {
         0.5,
         0.5,
         0.5, 
@@ -309,65 +524,356 @@ void RFInterface::exchange_data(const struct RFCmd &input) {
     channels[4] = input.flaps;
     channels[5] = input.gear;
     
-    for (int i = 0; i < 12; i++) {
-        body << "<item>" << channels[i] << "</item>";
+    // Only the channel slots change between frames
+    m_exchange_request.set_channels(channels);
+}
+
+
+bool RFInterface::exchange_data(const struct RFCmd &input) {
+    auto t0 = steady_clock::now();
+    fill_request(input);
+    m_latency.record(ExchangeStage::RequestBuild, t0, steady_clock::now());
+
+    ReplyView reply;
+    bool received = false;
+    int64_t traced_input = 0;
+    steady_clock::time_point sent_at;
+    if (m_uring.is_open()) {
+        // One submission for the whole connect/send/receive cycle
+        traced_input = trace_input_send(input.event_time_ns);
+        sent_at = steady_clock::now();
+        received = uring_request(m_exchange_request.data(), m_exchange_request.size(), 1000, reply);
+        record_command(input);  // submitted: logged whether or not a reply came, as on the socket path
+    } else {
+        // Send SOAP request
+        if (!soap_send(m_exchange_request.data(), m_exchange_request.size())) {
+            RF_LOG_ERROR("Failed to start SOAP request");
+            return false;
+        }
+        traced_input = trace_input_send(input.event_time_ns);
+        record_command(input);
+
+        // Get response
+        sent_at = m_sent_at;
+        received = soap_request_end(1000, reply);  // 1 second timeout
     }
     
-    body << "</m-channelValues-0to1>"
-         << "</pControlInputs>";
-    
-    std::string body_str = body.str();
-    
-    // Send SOAP request
-    if (!soap_request_start("ExchangeData", body_str.c_str())) {
-        std::cerr << "Failed to start SOAP request" << std::endl;
-        return;
+    if (received && reply.status != 200) {
+        RF_LOG_ERROR("ExchangeData request failed (HTTP %d)", reply.status);
+        return false;
     }
-    
-    // Get response
-    char* response = soap_request_end(1000);  // 1 second timeout
-    
-    if (response) {
+    if (received) {
         // std::cout << "\n=== Received SOAP Response ===" << std::endl;
         // std::cout << response << std::endl;
         // std::cout << "==============================\n" << std::endl;
         
-        parse_reply(response);
-    } else {
-        std::cerr << "Failed to receive response" << std::endl;
+        // A repeat of the last physics step is still a good exchange
+        if (accept_reply(reply.body, reply.body_size, sent_at)) trace_input_state(traced_input);
+        return true;
     }
+
+    RF_LOG_ERROR("Failed to receive response");
+    return false;
 }
 
-void RFInterface::parse_reply(const char *reply) {
-    // Lambda to extract values from xml tag
-    auto extract_value = [](const char* xml, const char* tag) -> double {
-        std::string search_tag = std::string("<") + tag + ">";
-        std::string end_tag = std::string("</") + tag + ">";
-        
-        const char* start = strstr(xml, search_tag.c_str());
-        if (!start) return 0.0;
-        
-        start += search_tag.length();
-        const char* end = strstr(start, end_tag.c_str());
-        if (!end) return 0.0;
-        
-        std::string value_str(start, end - start);
-        
-        // Handle boolean values
-        if (value_str == "true") return 1.0;
-        if (value_str == "false") return 0.0;
-        
-        try {
-            return std::stod(value_str);
-        } catch (...) {
-            return 0.0;
+void RFInterface::update_pipelined() {
+    m_in_flight.clear();
+    m_in_flight.resize(m_pipeline_depth);
+    for (auto& slot : m_in_flight) {
+        slot.response.reserve(HttpResponse::INITIAL_CAPACITY);
+    }
+    std::vector<struct pollfd> pfds(m_pipeline_depth);
+    std::vector<size_t> pfd_slot(m_pipeline_depth);
+
+    while (m_running.load() && m_connected) {
+        // Top up: every free slot gets a request carrying the latest command.
+        // When paced, at most one request goes out per period.
+        size_t busy = 0;
+        bool may_send = m_scheduler.tick();
+        for (auto& slot : m_in_flight) {
+            if (slot.fd >= 0) {
+                busy++;
+                continue;
+            }
+            if (!may_send) continue;
+
+            // Only wait for a socket when nothing else is in flight
+            if (!send_slot(slot, busy ? 0 : SOCKET_WAIT_MS)) break;
+            busy++;
+            if (m_scheduler.enabled()) may_send = false;
         }
-    };
-    
-    // Parse all state values using the keytable
-    for (int i = 0; i < num_keys; i++) {
-        double value = extract_value(reply, keytable[i].key);
-        keytable[i].ref = value;
+
+        nfds_t n = 0;
+        for (size_t i = 0; i < m_in_flight.size(); i++) {
+            if (m_in_flight[i].fd < 0) continue;
+            pfds[n] = {m_in_flight[i].fd, POLLIN, 0};
+            pfd_slot[n] = i;
+            n++;
+        }
+        // Wake for replies, or for the next period when paced
+        int64_t wait_ns = 10000000;
+        if (m_scheduler.enabled()) {
+            wait_ns = std::min(wait_ns, m_scheduler.ns_until_deadline());
+        }
+        struct timespec timeout = {0, static_cast<long>(wait_ns)};
+
+        if (n == 0) {
+            if (m_scheduler.enabled()) nanosleep(&timeout, nullptr);
+            continue;
+        }
+
+        if (ppoll(pfds.data(), n, &timeout, nullptr) < 0 && errno != EINTR) {
+            RF_LOG_ERROR("poll failed: %s", strerror(errno));
+            break;
+        }
+
+        auto now = steady_clock::now();
+        for (nfds_t i = 0; i < n; i++) {
+            InFlight& slot = m_in_flight[pfd_slot[i]];
+            bool done = false;
+
+            if (pfds[i].revents) {
+                done = read_slot(slot);
+            } else if (now - slot.sent_at > milliseconds(REPLY_TIMEOUT_MS)) {
+                RF_LOG_ERROR("Timeout or error waiting for response");
+                slot.response.fail();
+                done = true;
+            }
+
+            if (done) {
+                finish_slot(slot);
+            }
+        }
+    }
+
+    for (auto& slot : m_in_flight) {
+        if (slot.fd >= 0) close(slot.fd);
+        slot.fd = -1;
+    }
+}
+
+
+// Send the latest command on a pooled socket; false if no socket (or the
+// send failed)
+bool RFInterface::send_slot(InFlight &slot, uint32_t socket_wait_ms) {
+    auto t0 = steady_clock::now();
+    int fd = m_socket_pool->get_socket(socket_wait_ms);
+    if (fd < 0) return false;
+    auto t1 = steady_clock::now();
+    m_latency.record(ExchangeStage::SocketAcquire, t0, t1);
+
+    RFCmd cmd = next_command();
+    fill_request(cmd);
+    auto t2 = steady_clock::now();
+    m_latency.record(ExchangeStage::RequestBuild, t1, t2);
+    if (send(fd, m_exchange_request.data(), m_exchange_request.size(), MSG_NOSIGNAL | MSG_DONTWAIT) <
+        static_cast<ssize_t>(m_exchange_request.size())) {
+        RF_LOG_ERROR("Failed to send SOAP request: %s", strerror(errno));
+        close(fd);
+        return false;
+    }
+    slot.fd = fd;
+    slot.response.reset();
+    slot.sent_at = steady_clock::now();
+    m_latency.record(ExchangeStage::Send, t2, slot.sent_at);
+    slot.input_event_ns = trace_input_send(cmd.event_time_ns);
+    record_command(cmd);
+    slot.capture_id = m_capture.request(m_exchange_request.data(), m_exchange_request.size());
+    return true;
+}
+
+
+// Read whatever has arrived; true once the reply is complete or the
+// connection is done for
+bool RFInterface::read_slot(InFlight &slot) {
+    HttpResponse &response = slot.response;
+    size_t space;
+    char *dst = response.space(space);
+    if (!dst) {
+        RF_LOG_ERROR("Response larger than %zu bytes", HttpResponse::MAX_SIZE);
+        response.fail();
+        return true;
+    }
+
+    ssize_t got = recv(slot.fd, dst, space, MSG_DONTWAIT);
+    if (got > 0) {
+        if (response.size() == 0) {
+            m_latency.record(ExchangeStage::FirstByte, slot.sent_at, steady_clock::now());
+        }
+        response.commit(got);
+        return response.complete() || response.failed();
+    }
+    if (got == 0) {
+        response.finish();
+        return true;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return false;
+    response.fail();
+    return true;
+}
+
+
+void RFInterface::finish_slot(InFlight &slot) {
+    close(slot.fd);
+    slot.fd = -1;
+    const HttpResponse &response = slot.response;
+    m_capture.response(slot.capture_id, response.data(), response.size());
+    if (response.complete() && response.status() == 200) {
+        m_latency.record(ExchangeStage::Receive, slot.sent_at, steady_clock::now());
+        if (accept_reply(response.body(), response.body_size(), slot.sent_at)) trace_input_state(slot.input_event_ns);
+    }
+}
+
+
+// Reactor mode: a reply (or part of one) arrived
+bool RFInterface::on_event(int fd, uint32_t) {
+    for (auto& slot : m_in_flight) {
+        if (slot.fd != fd) continue;
+        if (!read_slot(slot)) return false;
+
+        m_reactor->unwatch(fd);
+        finish_slot(slot);
+        return true;  // free slot: send the next request now (or when due)
+    }
+    return false;
+}
+
+
+// Reactor mode: time out lost replies, fill free slots, and say when to
+// come back (next period, next reply timeout, or a retry for a socket)
+int64_t RFInterface::on_timer(int64_t now_ns) {
+    if (!m_running.load() || !m_connected) return 0;
+
+    auto now = steady_clock::now();
+    for (auto& slot : m_in_flight) {
+        if (slot.fd >= 0 && now - slot.sent_at > milliseconds(REPLY_TIMEOUT_MS)) {
+            RF_LOG_ERROR("Timeout or error waiting for response");
+            m_reactor->unwatch(slot.fd);
+            slot.response.fail();
+            finish_slot(slot);
+        }
+    }
+
+    bool may_send = m_scheduler.tick();
+    bool starved = false;
+    for (auto& slot : m_in_flight) {
+        if (slot.fd >= 0) continue;
+        if (!may_send) break;
+
+        // The pool refills on this same thread: never wait for a socket
+        if (!send_slot(slot, 0)) {
+            starved = true;
+            break;
+        }
+        m_reactor->watch(slot.fd, EPOLLIN, this);
+        if (m_scheduler.enabled()) may_send = false;
+    }
+
+    int64_t next = 0;
+    auto earliest = [&next](int64_t t) { next = next == 0 ? t : std::min(next, t); };
+    for (auto& slot : m_in_flight) {
+        if (slot.fd >= 0) {
+            earliest(now_ns + duration_cast<nanoseconds>(slot.sent_at + milliseconds(REPLY_TIMEOUT_MS) - now).count());
+        }
+    }
+    if (m_scheduler.enabled()) {
+        earliest(now_ns + std::max<int64_t>(m_scheduler.ns_until_deadline(), 1));
+    } else if (starved) {
+        earliest(now_ns + 1000000);  // pool empty: try again in 1 ms
+    }
+    return next;
+}
+
+
+bool RFInterface::accept_reply(const char *reply, size_t len, steady_clock::time_point sent_at) {
+    // A jump back by more than this is the sim restarting, not reordering
+    static constexpr double SIM_RESET_THRESHOLD_S = 1.0;
+
+    double t = peek_physics_time(reply, reply + len);
+    if (t < 0) {
+        // Tag missing or cut off: no way to order it against the last frame,
+        // and a bogus time would poison last_time_s and the clock fit
+        m_malformed_replies++;
+        RF_LOG_WARN("ExchangeData reply without m-currentPhysicsTime-SEC, dropped");
+        return false;
+    }
+    bool sim_reset = t < last_time_s - SIM_RESET_THRESHOLD_S;
+    if (m_frames.load() > 0 && !sim_reset) {
+        if (t == last_time_s) {
+            // Same physics step as the last frame: nothing new to parse
+            m_repeated_replies++;
+            return false;
+        }
+        if (t < last_time_s) {
+            m_stale_replies++;
+            return false;
+        }
+    }
+
+    auto t0 = steady_clock::now();
+    parse_reply(reply, len);
+    m_latency.record(ExchangeStage::Parse, t0, steady_clock::now());
+    last_time_s = t;
+    m_clock.update(t, state.m_currentPhysicsSpeedMultiplier,
+                   duration_cast<nanoseconds>(sent_at.time_since_epoch()).count(),
+                   duration_cast<nanoseconds>(t0.time_since_epoch()).count());
+    publish_state();
+    return true;
+}
+
+
+void RFInterface::publish_state() {
+    StateSnapshot snapshot;
+    snapshot.state = state;
+    snapshot.frame = ++m_frames;
+    snapshot.host_time_ns = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    snapshot.sim_time_ns = m_clock.estimate_local().to_host_ns(state.m_currentPhysicsTime_SEC);
+    m_snapshot.store(snapshot);
+
+    if (m_recorder.is_open()) {
+        m_recorder.record(RECORD_STATE, snapshot.frame, snapshot.host_time_ns, &state, sizeof(state));
+    }
+}
+
+
+StateSnapshot RFInterface::get_state() const {
+    StateSnapshot snapshot;
+    m_snapshot.load(snapshot);
+    return snapshot;
+}
+
+
+StateSnapshot RFInterface::wait_for_state(uint64_t after_frame, int timeout_ms) const {
+    // The seqlock version counts stores, which is exactly the frame number
+    m_snapshot.wait_for_update(after_frame, timeout_ms);
+    return get_state();
+}
+
+
+void RFInterface::parse_reply(const char *reply, size_t len) {
+    // One pass over the reply; tags are resolved through the compile-time
+    // hash table in reply_parser.hpp and land at their telemetry_schema
+    // offset in `state`. Fields outside m_telemetry_fields are not touched.
+    const TelemetryMask wanted = m_telemetry_fields;
+    TelemetryMask seen = 0;
+    int items = 0;
+    scan_reply(reply, reply + len,
+        [&](int i, double value) {
+            state.rcin[i] = value;
+            items = i + 1;
+        },
+        [&](int field, double value) {
+            telemetry_value(state, field) = value;
+            seen |= (uint64_t(1) << field);
+        },
+        wanted);
+
+    // Anything missing from the reply reads as 0
+    if (wanted & TELEMETRY_RCIN) {
+        for (int i = items; i < NUM_RCIN; i++) state.rcin[i] = 0.0;
+    }
+    for (TelemetryMask missing = wanted & TELEMETRY_TAGS_ALL & ~seen; missing; missing &= missing - 1) {
+        telemetry_value(state, __builtin_ctzll(missing)) = 0.0;
     }
     
     // Print some key values
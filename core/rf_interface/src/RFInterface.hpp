@@ -8,21 +8,148 @@
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <condition_variable>
+#include <memory>
 
 #include "socketpool.hpp"
-#include "joystick.hpp"
+#include "soap_request.hpp"
+#include "reply_parser.hpp"
+#include "telemetry_schema.hpp"
+#include "seqlock.hpp"
+#include "rate_scheduler.hpp"
+#include "latency_histogram.hpp"
+#include "flight_recorder.hpp"
+#include "wire_capture.hpp"
+#include "command_source.hpp"
+#include "uring_transport.hpp"
+#include "http_response.hpp"
+#include "clock_sync.hpp"
 
 using namespace std::chrono;
 
 namespace RF {
 
-class RFInterface {
+// One coherent, timestamped copy of the aircraft state
+struct StateSnapshot {
+    AircraftState state;
+    uint64_t frame;        // accepted replies so far, 0 = nothing received yet
+    int64_t host_time_ns;  // steady_clock time the reply was accepted
+    int64_t sim_time_ns;   // steady_clock time of its physics step (see ClockSync), 0 until synced
+};
+
+class RFInterface : private ReactorClient {
 public:
-    RFInterface(const char* rf_ip = "127.0.0.1", uint16_t rf_port = 18083);
+    // auto_start: connect and launch the update thread from the constructor.
+    // Pass false to drive exchange_data() manually (e.g. benchmarks).
+    //
+    // Every instance has its own socket pool for its own endpoint; the pools'
+    // connects (and reactor mode exchanges) run on `reactor`, by default one
+    // LinkReactor shared by the whole process.
+    RFInterface(const char* rf_ip = "127.0.0.1", uint16_t rf_port = 18083, bool auto_start = true,
+                std::shared_ptr<LinkReactor> reactor = nullptr);
     ~RFInterface();
 
     // Main update method like the original
     void update();
+
+    bool start();   // Connect and launch the update thread
+    void stop();    // Stop and join the update thread
+
+    // Number of ExchangeData requests kept in flight by update(), each on its
+    // own pooled socket. 1 (default) is the strictly serial loop. Replies that
+    // arrive out of order (by m-currentPhysicsTime-SEC) are dropped. Set
+    // before start().
+    void set_pipeline_depth(size_t depth);
+
+    // Run the exchange loop on the LinkReactor thread instead of an update
+    // thread of its own: sends, receives and pacing become events, so N
+    // instances (e.g. one per RealFlight host in a batch run) cost a single
+    // thread and never wait on each other. Pipeline depth, rate and the
+    // command source apply as in update(); the realtime options of
+    // set_scheduler() do not, the thread being shared. Set before start().
+    void set_reactor_mode(bool on) { m_reactor_mode = on; }
+
+    // Serial exchange_data() through io_uring: socket, connect, send and
+    // read go in as one linked submission, the reply lands in a registered
+    // buffer (see uring_transport.hpp). Returns false, and keeps the socket
+    // path, if the kernel cannot do it. Pipelined and reactor mode, and the
+    // connect/reset requests, always use sockets. Set before start().
+    bool set_io_uring(bool on);
+    bool io_uring_active() const { return m_uring.is_open(); }
+    uint64_t io_uring_enters() const { return m_uring.enters(); }
+
+    // Pace update() at a fixed rate (absolute-deadline clock_nanosleep), with
+    // optional SCHED_FIFO, CPU pinning and mlockall for the update thread.
+    // In pipelined mode one request is sent per period. Set before start().
+    void set_scheduler(const SchedulerConfig& config);
+    SchedulerStats scheduler_stats() const { return m_scheduler.stats(); }
+
+    uint64_t frames_received() const { return m_frames.load(); }
+
+    // Where update() takes the command for each request (see
+    // command_source.hpp). nullptr (default) uses external_commands(), fed
+    // through set_command(). Set before start().
+    void set_command_source(std::unique_ptr<CommandSource> source);
+
+    // Latest command for update() to send, e.g. from an autonomy loop at its
+    // own rate. Never blocks the caller or the update thread. stamp_ns is
+    // when the command was produced (steady clock, 0 = now); its age at send
+    // time shows up as the command_age latency stage.
+    void set_command(const RFCmd& cmd, int64_t stamp_ns = 0) { m_external.set_command(cmd, stamp_ns); }
+    ExternalSource& external_commands() { return m_external; }
+
+    // Per-stage timing of the exchange path (socket acquire, build, send,
+    // first byte, full receive, parse). Commands carrying an input event
+    // time (RFCmd::event_time_ns, e.g. from JoystickSource) are also traced
+    // from the event to the first request that carries them and to the
+    // state published from its reply. Recording is always on and lock-free;
+    // these can be called from any thread.
+    LatencySummary latency_summary(ExchangeStage stage) const { return m_latency.summary(stage); }
+    void print_latency(FILE* out = stdout) const { m_latency.print(out); }
+    void reset_latency() { m_latency.reset(); }
+
+    // Report per-stage latency every period_s seconds from a background
+    // thread while running: p50/p99 through the logger (RF_LOG_INFO), or the
+    // full table printed to `out` if one is given. 0 (default) disables it.
+    // Set before start().
+    void set_latency_report(double period_s, FILE* out = nullptr);
+
+    // Log every command sent and every state published, with host
+    // timestamps, to a pre-allocated memory-mapped ring of `capacity` binary
+    // records (see flight_recorder.hpp, rf_log_dump converts it to CSV).
+    // Call while the update thread is stopped.
+    bool start_recording(const char* path, size_t capacity = FlightRecorder::DEFAULT_CAPACITY);
+    void stop_recording();
+
+    // Save the raw bytes of every SOAP request and response, with timestamps,
+    // for rf_replay_server. Call while the update thread is stopped.
+    bool start_capture(const char* path);
+    void stop_capture();
+
+    // Latest state, never torn and never blocking the update thread
+    StateSnapshot get_state() const;
+
+    // Wait until a frame newer than `after_frame` is published (or timeout_ms
+    // passes, < 0 waits forever) and return the latest snapshot. Check
+    // snapshot.frame to tell a new frame from a timeout.
+    //
+    // A frame is a new physics step: a reply whose m-currentPhysicsTime-SEC
+    // has not moved since the last one (polling faster than the sim steps,
+    // or the sim paused) is neither parsed nor published, so every wake-up
+    // carries new data.
+    StateSnapshot wait_for_state(uint64_t after_frame, int timeout_ms = -1) const;
+    uint64_t stale_replies_dropped() const { return m_stale_replies.load(); }
+    uint64_t repeated_replies_dropped() const { return m_repeated_replies.load(); }
+    // Replies without a readable m-currentPhysicsTime-SEC, never published
+    uint64_t malformed_replies_dropped() const { return m_malformed_replies.load(); }
+
+    // Offset, rate and one-way delay between the sim's physics clock and the
+    // host steady clock, as fitted from the fresh frames so far. Any thread.
+    ClockEstimate sim_clock() const { return m_clock.estimate(); }
+
+    // One ExchangeData round trip: send `input`, parse the reply into `state`.
+    // Not thread safe against a running update thread.
+    bool exchange_data(const struct RFCmd &input);
     
     // Control mode switching
     bool connect();   // Connect and enable (RealFlight Link) control
@@ -31,141 +158,110 @@ public:
     // Aircraft control
     bool reset_aircraft();  // Reset aircraft position (like pressing spacebar)
 
-    struct state {
-        double rcin[12];
-        double m_airspeed_MPS;
-        double m_altitudeASL_MTR;
-        double m_altitudeAGL_MTR;
-        double m_groundspeed_MPS;
-        double m_pitchRate_DEGpSEC;
-        double m_rollRate_DEGpSEC;
-        double m_yawRate_DEGpSEC;
-        double m_azimuth_DEG;
-        double m_inclination_DEG;
-        double m_roll_DEG;
-        double m_aircraftPositionX_MTR;
-        double m_aircraftPositionY_MTR;
-        double m_velocityWorldU_MPS;
-        double m_velocityWorldV_MPS;
-        double m_velocityWorldW_MPS;
-        double m_velocityBodyU_MPS;
-        double m_velocityBodyV_MPS;
-        double m_velocityBodyW_MPS;
-        double m_accelerationWorldAX_MPS2;
-        double m_accelerationWorldAY_MPS2;
-        double m_accelerationWorldAZ_MPS2;
-        double m_accelerationBodyAX_MPS2;
-        double m_accelerationBodyAY_MPS2;
-        double m_accelerationBodyAZ_MPS2;
-        double m_windX_MPS;
-        double m_windY_MPS;
-        double m_windZ_MPS;
-        double m_propRPM;
-        double m_heliMainRotorRPM;
-        double m_batteryVoltage_VOLTS;
-        double m_batteryCurrentDraw_AMPS;
-        double m_batteryRemainingCapacity_MAH;
-        double m_fuelRemaining_OZ;
-        double m_isLocked;
-        double m_hasLostComponents;
-        double m_anEngineIsRunning;
-        double m_isTouchingGround;
-        double m_currentAircraftStatus;
-        double m_currentPhysicsTime_SEC;
-        double m_currentPhysicsSpeedMultiplier;
-        double m_orientationQuaternion_X;
-        double m_orientationQuaternion_Y;
-        double m_orientationQuaternion_Z;
-        double m_orientationQuaternion_W;
-        double m_flightAxisControllerIsActive;
-        double m_resetButtonHasBeenPressed;
-    } state;
-
-    static const uint16_t num_keys = sizeof(state)/sizeof(double);
-
-    struct keytable {
-        const char *key;
-        double &ref;
-    } keytable[num_keys] = {
-        { "item", state.rcin[0] },
-        { "item", state.rcin[1] },
-        { "item", state.rcin[2] },
-        { "item", state.rcin[3] },
-        { "item", state.rcin[4] },
-        { "item", state.rcin[5] },
-        { "item", state.rcin[6] },
-        { "item", state.rcin[7] },
-        { "item", state.rcin[8] },
-        { "item", state.rcin[9] },
-        { "item", state.rcin[10] },
-        { "item", state.rcin[11] },
-        { "m-airspeed-MPS", state.m_airspeed_MPS },
-        { "m-altitudeASL-MTR", state.m_altitudeASL_MTR },
-        { "m-altitudeAGL-MTR", state.m_altitudeAGL_MTR },
-        { "m-groundspeed-MPS", state.m_groundspeed_MPS },
-        { "m-pitchRate-DEGpSEC", state.m_pitchRate_DEGpSEC },
-        { "m-rollRate-DEGpSEC", state.m_rollRate_DEGpSEC },
-        { "m-yawRate-DEGpSEC", state.m_yawRate_DEGpSEC },
-        { "m-azimuth-DEG", state.m_azimuth_DEG },
-        { "m-inclination-DEG", state.m_inclination_DEG },
-        { "m-roll-DEG", state.m_roll_DEG },
-        { "m-aircraftPositionX-MTR", state.m_aircraftPositionX_MTR },
-        { "m-aircraftPositionY-MTR", state.m_aircraftPositionY_MTR },
-        { "m-velocityWorldU-MPS", state.m_velocityWorldU_MPS },
-        { "m-velocityWorldV-MPS", state.m_velocityWorldV_MPS },
-        { "m-velocityWorldW-MPS", state.m_velocityWorldW_MPS },
-        { "m-velocityBodyU-MPS", state.m_velocityBodyU_MPS },
-        { "m-velocityBodyV-MPS", state.m_velocityBodyV_MPS },
-        { "m-velocityBodyW-MPS", state.m_velocityBodyW_MPS },
-        { "m-accelerationWorldAX-MPS2", state.m_accelerationWorldAX_MPS2 },
-        { "m-accelerationWorldAY-MPS2", state.m_accelerationWorldAY_MPS2 },
-        { "m-accelerationWorldAZ-MPS2", state.m_accelerationWorldAZ_MPS2 },
-        { "m-accelerationBodyAX-MPS2", state.m_accelerationBodyAX_MPS2 },
-        { "m-accelerationBodyAY-MPS2", state.m_accelerationBodyAY_MPS2 },
-        { "m-accelerationBodyAZ-MPS2", state.m_accelerationBodyAZ_MPS2 },
-        { "m-windX-MPS", state.m_windX_MPS },
-        { "m-windY-MPS", state.m_windY_MPS },
-        { "m-windZ-MPS", state.m_windZ_MPS },
-        { "m-propRPM", state.m_propRPM },
-        { "m-heliMainRotorRPM", state.m_heliMainRotorRPM },
-        { "m-batteryVoltage-VOLTS", state.m_batteryVoltage_VOLTS },
-        { "m-batteryCurrentDraw-AMPS", state.m_batteryCurrentDraw_AMPS },
-        { "m-batteryRemainingCapacity-MAH", state.m_batteryRemainingCapacity_MAH },
-        { "m-fuelRemaining-OZ", state.m_fuelRemaining_OZ },
-        { "m-isLocked", state.m_isLocked },
-        { "m-hasLostComponents", state.m_hasLostComponents },
-        { "m-anEngineIsRunning", state.m_anEngineIsRunning },
-        { "m-isTouchingGround", state.m_isTouchingGround },
-        { "m-currentAircraftStatus", state.m_currentAircraftStatus },
-        { "m-currentPhysicsTime-SEC", state.m_currentPhysicsTime_SEC },
-        { "m-currentPhysicsSpeedMultiplier", state.m_currentPhysicsSpeedMultiplier },
-        { "m-orientationQuaternion-X", state.m_orientationQuaternion_X },
-        { "m-orientationQuaternion-Y", state.m_orientationQuaternion_Y },
-        { "m-orientationQuaternion-Z", state.m_orientationQuaternion_Z },
-        { "m-orientationQuaternion-W", state.m_orientationQuaternion_W },
-        { "m-flightAxisControllerIsActive", state.m_flightAxisControllerIsActive },
-        { "m-resetButtonHasBeenPressed", state.m_resetButtonHasBeenPressed },
-    };
+    // Written by the update thread while it parses a reply. Other threads
+    // must read through get_state() / wait_for_state() instead.
+    AircraftState state;
+
+    // Parts of each reply to decode (see telemetry_schema.hpp), e.g.
+    // TELEMETRY_ATTITUDE | TELEMETRY_POSITION; the rest of `state` stays 0
+    // and costs no parsing. m-currentPhysicsTime-SEC and
+    // m-currentPhysicsSpeedMultiplier are always decoded, they order the
+    // replies and drive sim_clock(). Default TELEMETRY_ALL. Set before start().
+    void set_telemetry_fields(TelemetryMask fields) { m_telemetry_fields = fields | TELEMETRY_CLOCK; }
+    TelemetryMask telemetry_fields() const { return m_telemetry_fields; }
+
 
     bool isRFConnected();
 
 private:
     std::thread m_update_thread;
 
-    Joystick m_joystick;
+    ExternalSource m_external;
+    std::unique_ptr<CommandSource> m_owned_source;
+    CommandSource* m_source = &m_external;
+
+    // Framed reply to a serial request; body points into the reply buffer
+    // and stays valid until the next request
+    struct ReplyView {
+        int status = 0;
+        const char *body = nullptr;
+        size_t body_size = 0;
+    };
 
     bool soap_request_start(const char *action, const char *fmt, ...);
-    char *soap_request_end(uint32_t timeout_ms);
-    void exchange_data(const struct RFCmd &input);
-    void parse_reply(const char *reply);
+    bool soap_send(const char *request, size_t len);
+    bool soap_request_end(uint32_t timeout_ms, ReplyView &reply);
+    bool uring_request(const char *request, size_t len, uint32_t timeout_ms, ReplyView &reply);
+    void parse_reply(const char *reply, size_t len);
+    void fill_request(const struct RFCmd &input);
+    void update_pipelined();
+    bool on_event(int fd, uint32_t events) override;
+    int64_t on_timer(int64_t now_ns) override;
+    bool accept_reply(const char *reply, size_t len, steady_clock::time_point sent_at);
+    void publish_state();
+    void report_latency();
+    void record_command(const struct RFCmd &input);
+    int64_t trace_input_send(int64_t event_ns);
+    void trace_input_state(int64_t event_ns);
+    RFCmd next_command();
     
+    // How long a request waits for the pool to hand out a connected socket
+    static constexpr uint32_t SOCKET_WAIT_MS = 100;
+    // Pipelined and reactor mode: give up on a reply after this long
+    static constexpr int REPLY_TIMEOUT_MS = 1000;
+
     const char* rf_server_ip;  // Windows machine IP on which RF is running
     uint16_t rf_server_port;   // 18083 or whatever RF uses
+    std::shared_ptr<LinkReactor> m_reactor;
+    std::unique_ptr<SocketPool> m_socket_pool;
+    bool m_reactor_mode = false;
     int sock_fd;
-    char reply_buffer[10000];
+    HttpResponse m_response;  // serial socket path, reused for every request
+    ExchangeRequest m_exchange_request;
+    UringTransport m_uring;
+    static constexpr size_t URING_BUFFER_SIZE = 65536;  // registered, so fixed
+    std::unique_ptr<char[]> m_uring_buffer;
+    HttpResponseParser m_uring_framing;
 
     bool m_connected;
-    double last_time_s = 0;
+    std::atomic_bool m_running{false};
+    double last_time_s = 0;  // m-currentPhysicsTime-SEC of the last accepted reply
+    int64_t m_traced_input_ns = 0;  // input event already traced to a send
+    TelemetryMask m_telemetry_fields = TELEMETRY_ALL;
+
+    std::atomic<uint64_t> m_frames{0};
+    SeqLock<StateSnapshot> m_snapshot;
+    std::atomic<uint64_t> m_stale_replies{0};
+    std::atomic<uint64_t> m_repeated_replies{0};
+    std::atomic<uint64_t> m_malformed_replies{0};
+    ClockSync m_clock;
+
+    // Pipelined and reactor mode: one slot per request in flight
+    struct InFlight {
+        int fd = -1;
+        steady_clock::time_point sent_at;
+        uint64_t capture_id = 0;
+        int64_t input_event_ns = 0;  // traced input event this request carries
+        HttpResponse response;
+    };
+    size_t m_pipeline_depth = 1;
+    RateScheduler m_scheduler;
+    std::vector<InFlight> m_in_flight;
+
+    bool send_slot(InFlight &slot, uint32_t socket_wait_ms);
+    bool read_slot(InFlight &slot);
+    void finish_slot(InFlight &slot);
+
+    ExchangeLatency m_latency;
+    FlightRecorder m_recorder;
+    WireCapture m_capture;
+    uint64_t m_capture_id = 0;  // serial mode: capture id of the request in flight
+    steady_clock::time_point m_sent_at;  // serial mode: last soap_send() completion
+    double m_report_period_s = 0;
+    FILE* m_report_out = nullptr;  // nullptr: through the logger
+    std::thread m_report_thread;
+    std::mutex m_report_mutex;
+    std::condition_variable m_report_cv;
 };
 
 } // namespace RF
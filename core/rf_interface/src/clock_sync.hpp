@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "seqlock.hpp"
+
+namespace RF {
+
+// Where the simulator's physics clock sits on the host steady clock
+struct ClockEstimate {
+    bool valid = false;
+    double sim_time_s = 0.0;           // reference point: a physics time...
+    int64_t host_time_ns = 0;          // ...and the host time it happened at
+    double host_ns_per_sim_s = 1e9;    // host ns per physics second (1e9 / speed at nominal)
+    double speed_multiplier = 1.0;     // m-currentPhysicsSpeedMultiplier
+    double drift_ppm = 0.0;            // measured rate vs. 1e9 / speed_multiplier
+    int64_t one_way_delay_ns = 0;      // reply transit, half the best recent round trip
+    int64_t round_trip_ns = 0;         // of the last sample
+    uint64_t samples = 0;              // fresh frames fed since the last resync
+    uint64_t resyncs = 0;              // sim reset, speed change, pause or time jump
+
+    // Host steady clock time (ns) of physics time sim_s, 0 if not synced yet
+    int64_t to_host_ns(double sim_s) const {
+        if (!valid) return 0;
+        return host_time_ns + static_cast<int64_t>(std::llround((sim_s - sim_time_s) * host_ns_per_sim_s));
+    }
+};
+
+// Estimates offset, rate (drift) and one-way delay between the simulator's
+// physics clock and the host steady clock, from the request/reply timing of
+// each fresh frame.
+//
+// A reply's physics time is taken to have happened at the midpoint of its
+// round trip (as in NTP), so every sample is off by at most half its round
+// trip. The samples go into a least-squares line fit with exponential
+// forgetting (about WINDOW samples), weighted by how close each round trip
+// is to the best recent one, so a reply held up by the network or the sim
+// barely moves the fit.
+//
+// When the sim restarts, changes speed, or comes back from a pause (host
+// time kept running, physics time did not), the samples stop fitting the
+// line and the fit starts over.
+//
+// update() runs on the exchange thread and does not allocate; estimate()
+// can be called from any thread.
+class ClockSync {
+public:
+    static constexpr double WINDOW = 256.0;                // samples
+    static constexpr int64_t RESYNC_ERROR_NS = 20000000;   // 20 ms beyond the round trip
+    static constexpr double PRIOR = 1.0;                   // s^2, see Fit::slope()
+
+    void reset() {
+        m_fit = Fit();
+        m_estimate = ClockEstimate();
+        m_published.store(m_estimate);
+    }
+
+    // A fresh frame: physics time sim_s at speed_multiplier, from a request
+    // sent at send_ns whose reply was complete at recv_ns (steady clock)
+    void update(double sim_s, double speed_multiplier, int64_t send_ns, int64_t recv_ns) {
+        if (!(speed_multiplier > 0.0)) speed_multiplier = 1.0;
+        int64_t rtt = std::max<int64_t>(recv_ns - send_ns, 0);
+        int64_t mid = send_ns + rtt / 2;
+        ClockEstimate& e = m_estimate;
+
+        bool resync = !e.valid || speed_multiplier != e.speed_multiplier || sim_s < e.sim_time_s - 1.0;
+        if (!resync) {
+            int64_t error = mid - e.to_host_ns(sim_s);
+            resync = std::llabs(error) > RESYNC_ERROR_NS + rtt;
+        }
+        if (resync) {
+            if (e.valid) e.resyncs++;
+            m_fit = Fit();
+            m_fit.sim0 = sim_s;
+            m_fit.host0 = mid;
+            m_rtt_floor = static_cast<double>(rtt);
+            e.samples = 0;
+            e.speed_multiplier = speed_multiplier;
+        }
+
+        // Best recent round trip: follows drops at once, rises slowly
+        m_rtt_floor = std::min(static_cast<double>(rtt), m_rtt_floor + (rtt - m_rtt_floor) / WINDOW);
+        double quality = rtt > 0 ? std::min(1.0, (m_rtt_floor + 1000.0) / (rtt + 1000.0)) : 1.0;
+        add_sample(sim_s, mid, quality * quality);
+
+        double nominal = 1e9 / speed_multiplier;
+        double slope = m_fit.slope(nominal);
+        e.valid = true;
+        e.sim_time_s = sim_s;
+        e.host_time_ns = m_fit.host0 + static_cast<int64_t>(std::llround(m_fit.at(sim_s - m_fit.sim0, slope)));
+        e.host_ns_per_sim_s = slope;
+        e.drift_ppm = (slope / nominal - 1.0) * 1e6;
+        e.one_way_delay_ns = static_cast<int64_t>(m_rtt_floor / 2);
+        e.round_trip_ns = rtt;
+        e.samples++;
+        m_published.store(e);
+    }
+
+    // Latest estimate, from any thread
+    ClockEstimate estimate() const {
+        ClockEstimate e;
+        m_published.load(e);
+        return e;
+    }
+
+    // Same, for the exchange thread (no seqlock read)
+    const ClockEstimate& estimate_local() const { return m_estimate; }
+
+private:
+    // Weighted least squares of host = host0 + a + b * (sim - sim0), sums
+    // decaying by 1 - 1/WINDOW per sample. Re-centered now and then so the
+    // sums stay small and precise over long runs.
+    struct Fit {
+        double sim0 = 0.0;
+        int64_t host0 = 0;
+        double w = 0, x = 0, y = 0, xx = 0, xy = 0;
+
+        // Pulled towards `nominal` as if by PRIOR s^2 of extra spread, so
+        // the first few samples, close together in physics time, cannot
+        // produce a wild rate
+        double slope(double nominal) const {
+            if (w <= 0) return nominal;
+            double sxx = xx - x * x / w;
+            double sxy = xy - x * y / w;
+            return (sxy + PRIOR * nominal) / (sxx + PRIOR);
+        }
+
+        // Fitted host offset (ns from host0) at dx seconds from sim0
+        double at(double dx, double slope) const {
+            if (w <= 0) return 0.0;
+            return y / w + slope * (dx - x / w);
+        }
+
+        void shift(double dx, double dy) {
+            xy += -dx * y - dy * x + dx * dy * w;
+            xx += -2 * dx * x + dx * dx * w;
+            x -= dx * w;
+            y -= dy * w;
+        }
+    };
+
+    void add_sample(double sim_s, int64_t host_ns, double weight) {
+        Fit& f = m_fit;
+        double dx = sim_s - f.sim0;
+        if (std::fabs(dx) > 60.0) {
+            // Move the origin to this sample
+            double dy = static_cast<double>(host_ns - f.host0);
+            f.shift(dx, dy);
+            f.sim0 = sim_s;
+            f.host0 = host_ns;
+            dx = 0.0;
+        }
+        double dy = static_cast<double>(host_ns - f.host0);
+
+        const double keep = 1.0 - 1.0 / WINDOW;
+        f.w = f.w * keep + weight;
+        f.x = f.x * keep + weight * dx;
+        f.y = f.y * keep + weight * dy;
+        f.xx = f.xx * keep + weight * dx * dx;
+        f.xy = f.xy * keep + weight * dx * dy;
+    }
+
+    Fit m_fit;
+    double m_rtt_floor = 0.0;
+    ClockEstimate m_estimate;
+    SeqLock<ClockEstimate> m_published;
+};
+
+} // namespace RF
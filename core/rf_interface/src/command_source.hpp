@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <time.h>
+
+#include "joystick.hpp"
+#include "seqlock.hpp"
+
+namespace RF {
+
+// A command and the steady clock time (ns) it was produced, 0 if unknown
+struct TimedCommand {
+    RFCmd cmd;
+    int64_t stamp_ns;
+};
+
+inline int64_t command_clock_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);  // = std::chrono::steady_clock on Linux
+    return int64_t(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// Where the exchange loop gets the command for the next request.
+//
+// latest() runs on the exchange thread once per request: it must return the
+// most recent command without blocking or allocating. Producers hand
+// commands over through lock-free latest-value slots, so a slow or bursty
+// producer can never delay a request, only make it carry an older command.
+class CommandSource {
+public:
+    virtual ~CommandSource() = default;
+    virtual TimedCommand latest() = 0;
+};
+
+// Commands pushed by the application (autonomy loop, ROS subscription...)
+// through set_command(). Until the first one arrives latest() returns
+// NEUTRAL_COMMAND with stamp 0.
+class ExternalSource : public CommandSource {
+public:
+    // Never blocks. One writer at a time. stamp_ns defaults to now.
+    void set_command(const RFCmd& cmd, int64_t stamp_ns = 0) {
+        m_slot.store(TimedCommand{cmd, stamp_ns ? stamp_ns : command_clock_ns()});
+    }
+
+    TimedCommand latest() override {
+        TimedCommand out;
+        load(out);
+        return out;
+    }
+
+    // Like latest(), also returning how many set_command() calls it reflects
+    uint64_t load(TimedCommand& out) const {
+        uint64_t version = m_slot.load(out);
+        if (version == 0) out = TimedCommand{NEUTRAL_COMMAND, 0};
+        return version;
+    }
+
+    uint64_t commands() const { return m_slot.version(); }
+
+private:
+    SeqLock<TimedCommand> m_slot;
+};
+
+// Sticks of an evdev joystick, as committed by its reader thread
+// (NEUTRAL_COMMAND while its Disable input is set), stamped with the time
+// of the input event that completed the frame
+class JoystickSource : public CommandSource {
+public:
+    explicit JoystickSource(const char* device = "/dev/input/event0",
+                            const JoystickMap& map = JoystickMap::defaults())
+        : m_device(device), m_joystick(m_device.c_str(), map) {}
+
+    TimedCommand latest() override {
+        RFCmd cmd = m_joystick.getJoystickVals();
+        return TimedCommand{cmd, cmd.event_time_ns};
+    }
+
+    Joystick& joystick() { return m_joystick; }
+
+private:
+    std::string m_device;  // Joystick keeps the pointer
+    Joystick m_joystick;
+};
+
+// Pilot and autopilot sharing the controls: every axis is
+// pilot * (1 - authority) + autopilot * authority. The autopilot only counts
+// while its commands are fresh; if none arrived for stale_ns the pilot gets
+// full authority back, so a dead autonomy process hands the plane back to
+// the sticks.
+class BlendedSource : public CommandSource {
+public:
+    static constexpr int64_t DEFAULT_STALE_NS = 200000000;  // 200 ms
+
+    // `autopilot` is not owned (typically RFInterface::external_commands())
+    BlendedSource(std::unique_ptr<CommandSource> pilot, CommandSource& autopilot,
+                  double authority = 1.0, int64_t stale_ns = DEFAULT_STALE_NS)
+        : m_pilot(std::move(pilot)), m_autopilot(autopilot), m_stale_ns(stale_ns) {
+        set_authority(authority);
+    }
+
+    // 0 = pilot only, 1 = autopilot only. Any thread, takes effect on the next request.
+    void set_authority(double authority) {
+        m_authority.store(std::min(std::max(authority, 0.0), 1.0), std::memory_order_relaxed);
+    }
+    double authority() const { return m_authority.load(std::memory_order_relaxed); }
+
+    TimedCommand latest() override {
+        TimedCommand pilot = m_pilot->latest();
+        TimedCommand autopilot = m_autopilot.latest();
+
+        double w = m_authority.load(std::memory_order_relaxed);
+        if (autopilot.stamp_ns == 0 || command_clock_ns() - autopilot.stamp_ns > m_stale_ns) {
+            w = 0.0;
+        }
+        if (w <= 0.0) return pilot;
+        if (w >= 1.0) return autopilot;
+
+        const RFCmd& p = pilot.cmd;
+        const RFCmd& a = autopilot.cmd;
+        auto mix = [w](double x, double y) { return x + (y - x) * w; };
+        TimedCommand out;
+        out.cmd = RFCmd{mix(p.throttle, a.throttle), mix(p.aileron, a.aileron), mix(p.elevator, a.elevator),
+                        mix(p.rudder, a.rudder), mix(p.flaps, a.flaps), mix(p.gear, a.gear),
+                        std::max(p.event_time_ns, a.event_time_ns)};
+        out.stamp_ns = std::max(pilot.stamp_ns, autopilot.stamp_ns);
+        return out;
+    }
+
+private:
+    std::unique_ptr<CommandSource> m_pilot;
+    CommandSource& m_autopilot;
+    int64_t m_stale_ns;
+    std::atomic<double> m_authority{1.0};
+};
+
+} // namespace RF
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "async_log.hpp"
+
+namespace RF {
+
+// On-disk layout of a flight log:
+//   [FlightLogHeader, padded to one page][FlightRecord x capacity]
+// The records form a ring: record n (0-based) lives in slot n % capacity, so
+// a full log holds the last `capacity` records.
+static constexpr char FLIGHT_LOG_MAGIC[8] = {'R', 'F', 'L', 'O', 'G', 0, 0, 1};
+static constexpr uint32_t FLIGHT_LOG_VERSION = 1;
+static constexpr size_t FLIGHT_LOG_HEADER_SIZE = 4096;
+
+enum FlightRecordType : uint32_t {
+    RECORD_CMD = 1,    // RFCmd sent to the sim
+    RECORD_STATE = 2,  // AircraftState received from the sim
+};
+
+struct FlightLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;         // slots in the ring
+    uint64_t written;          // records written so far (may exceed capacity)
+    int64_t steady_origin_ns;  // steady_clock and CLOCK_REALTIME read together
+    int64_t realtime_origin_ns;  // at open, to map host_time_ns to wall time
+    uint32_t cmd_size;         // sizeof(RFCmd) / sizeof(AircraftState) of the
+    uint32_t state_size;       // writer, checked by readers
+};
+
+struct FlightRecord {
+    static constexpr size_t SIZE = 512;
+    static constexpr size_t MAX_PAYLOAD = SIZE - 32;
+
+    uint64_t seq;           // record number + 1; 0 = never written or being written
+    int64_t host_time_ns;   // steady_clock
+    uint32_t type;          // FlightRecordType
+    uint32_t size;          // payload bytes used
+    uint64_t frame;         // state frame number (for commands: latest frame when sent)
+    unsigned char payload[MAX_PAYLOAD];
+};
+static_assert(sizeof(FlightRecord) == FlightRecord::SIZE, "FlightRecord must stay fixed size");
+static_assert(sizeof(FlightLogHeader) <= FLIGHT_LOG_HEADER_SIZE, "FlightLogHeader too big");
+
+// Binary flight-data recorder backed by a pre-allocated, memory-mapped file.
+//
+// The file is sized and faulted in when opened, so record() is a memcpy into
+// mapped memory: no syscalls, no allocation, no formatting. A background
+// thread msync()s the written range periodically so the log survives a crash
+// of the process (not of the machine) up to the last flush interval.
+//
+// record() must be called from one thread at a time.
+class FlightRecorder {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 65536;  // 32 MB
+    static constexpr int DEFAULT_FLUSH_MS = 200;
+
+    FlightRecorder() = default;
+    ~FlightRecorder() { close(); }
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    bool open(const char* path, size_t capacity = DEFAULT_CAPACITY,
+              uint32_t cmd_size = 0, uint32_t state_size = 0, int flush_ms = DEFAULT_FLUSH_MS) {
+        close();
+        if (capacity == 0) return false;
+
+        m_size = FLIGHT_LOG_HEADER_SIZE + capacity * sizeof(FlightRecord);
+        m_fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (m_fd < 0) {
+            RF_LOG_ERROR("FlightRecorder: cannot open %s: %s", path, strerror(errno));
+            return false;
+        }
+
+        // Reserve the blocks now; running out of disk later would SIGBUS the writer
+        int err = posix_fallocate(m_fd, 0, m_size);
+        if (err != 0) {
+            RF_LOG_ERROR("FlightRecorder: cannot allocate %zu bytes for %s: %s", m_size, path, strerror(err));
+            close();
+            return false;
+        }
+
+        void* map = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, 0);
+        if (map == MAP_FAILED) {
+            RF_LOG_ERROR("FlightRecorder: mmap failed: %s", strerror(errno));
+            map = nullptr;
+            close();
+            return false;
+        }
+
+        m_base = static_cast<unsigned char*>(map);
+        m_header = reinterpret_cast<FlightLogHeader*>(m_base);
+        m_records = reinterpret_cast<FlightRecord*>(m_base + FLIGHT_LOG_HEADER_SIZE);
+        m_capacity = capacity;
+        m_next = 0;
+        m_flushed = 0;
+
+        memcpy(m_header->magic, FLIGHT_LOG_MAGIC, sizeof(FLIGHT_LOG_MAGIC));
+        m_header->version = FLIGHT_LOG_VERSION;
+        m_header->record_size = sizeof(FlightRecord);
+        m_header->capacity = capacity;
+        m_header->written = 0;
+        m_header->cmd_size = cmd_size;
+        m_header->state_size = state_size;
+
+        struct timespec rt;
+        clock_gettime(CLOCK_REALTIME, &rt);
+        m_header->steady_origin_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        m_header->realtime_origin_ns = int64_t(rt.tv_sec) * 1000000000LL + rt.tv_nsec;
+
+        m_flush_ms = flush_ms;
+        m_stop = false;
+        m_flusher = std::thread(&FlightRecorder::flush_loop, this);
+        return true;
+    }
+
+    // Flush everything to disk and unmap
+    void close() {
+        if (m_flusher.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+            m_flusher.join();
+        }
+        if (m_base) {
+            msync(m_base, m_size, MS_SYNC);
+            munmap(m_base, m_size);
+        }
+        if (m_fd >= 0) ::close(m_fd);
+
+        m_base = nullptr;
+        m_header = nullptr;
+        m_records = nullptr;
+        m_fd = -1;
+        m_capacity = 0;
+    }
+
+    bool is_open() const { return m_base != nullptr; }
+
+    // Hot path. Payloads longer than FlightRecord::MAX_PAYLOAD are truncated.
+    void record(FlightRecordType type, uint64_t frame, int64_t host_time_ns, const void* data, size_t len) {
+        if (!m_base) return;
+        len = std::min(len, FlightRecord::MAX_PAYLOAD);
+
+        uint64_t n = m_next++;
+        FlightRecord& r = m_records[n % m_capacity];
+
+        // seq goes to 0 while the slot is rewritten so a reader of a live
+        // (or crashed) log can tell a torn record
+        __atomic_store_n(&r.seq, 0, __ATOMIC_RELAXED);
+        std::atomic_thread_fence(std::memory_order_release);
+        r.host_time_ns = host_time_ns;
+        r.type = type;
+        r.size = static_cast<uint32_t>(len);
+        r.frame = frame;
+        memcpy(r.payload, data, len);
+        __atomic_store_n(&r.seq, n + 1, __ATOMIC_RELEASE);
+        __atomic_store_n(&m_header->written, n + 1, __ATOMIC_RELEASE);
+    }
+
+    uint64_t records_written() const {
+        return m_header ? __atomic_load_n(&m_header->written, __ATOMIC_ACQUIRE) : 0;
+    }
+
+private:
+    void flush_loop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_cv.wait_for(lock, std::chrono::milliseconds(m_flush_ms), [this] { return m_stop; })) {
+            flush_written();
+        }
+    }
+
+    // MS_ASYNC the pages of records written since the last pass
+    void flush_written() {
+        uint64_t written = records_written();
+        if (written == m_flushed) return;
+
+        uint64_t from = m_flushed;
+        if (written - from >= m_capacity) from = written - m_capacity;
+
+        uint64_t first = from % m_capacity;
+        uint64_t last = (written - 1) % m_capacity;
+        if (first <= last) {
+            sync_slots(first, last + 1);
+        } else {
+            sync_slots(first, m_capacity);
+            sync_slots(0, last + 1);
+        }
+        msync(m_base, FLIGHT_LOG_HEADER_SIZE, MS_ASYNC);
+        m_flushed = written;
+    }
+
+    void sync_slots(uint64_t begin, uint64_t end) {
+        static const size_t page = sysconf(_SC_PAGESIZE);
+        size_t offset = FLIGHT_LOG_HEADER_SIZE + begin * sizeof(FlightRecord);
+        size_t aligned = offset & ~(page - 1);
+        size_t length = FLIGHT_LOG_HEADER_SIZE + end * sizeof(FlightRecord) - aligned;
+        msync(m_base + aligned, length, MS_ASYNC);
+    }
+
+    int m_fd = -1;
+    size_t m_size = 0;
+    unsigned char* m_base = nullptr;
+    FlightLogHeader* m_header = nullptr;
+    FlightRecord* m_records = nullptr;
+    uint64_t m_capacity = 0;
+    uint64_t m_next = 0;     // writer only
+    uint64_t m_flushed = 0;  // flusher only
+
+    int m_flush_ms = DEFAULT_FLUSH_MS;
+    bool m_stop = false;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_flusher;
+};
+
+} // namespace RF
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <strings.h>
+#include <memory>
+
+namespace RF {
+
+// Incremental HTTP/1.1 response framing over a caller-owned buffer.
+//
+// feed() is handed the buffer and everything received so far after each
+// read. Only bytes it has not looked at before are scanned for the end of
+// the header block; the status line and headers are parsed once, after
+// which the body is just counted against Content-Length. Without a
+// Content-Length the body runs until the server closes (finish()).
+class HttpResponseParser {
+public:
+    enum State { HEADERS, BODY, COMPLETE, FAILED };
+    static constexpr size_t NO_LENGTH = SIZE_MAX;
+
+    void reset() {
+        m_state = HEADERS;
+        m_scanned = 0;
+        m_header_size = 0;
+        m_content_length = NO_LENGTH;
+        m_status = 0;
+    }
+
+    // `data` holds the `size` bytes received so far; earlier bytes must not
+    // have changed since the last call
+    State feed(const char* data, size_t size) {
+        if (m_state == HEADERS) {
+            // The terminator may straddle the previous read
+            size_t from = m_scanned > 3 ? m_scanned - 3 : 0;
+            const char* end = size > from ? static_cast<const char*>(memmem(data + from, size - from, "\r\n\r\n", 4))
+                                          : nullptr;
+            m_scanned = size;
+            if (!end) return m_state;
+
+            m_header_size = end + 4 - data;
+            if (!parse_headers(data, m_header_size)) {
+                m_state = FAILED;
+                return m_state;
+            }
+            m_state = BODY;
+        }
+        if (m_state == BODY && m_content_length != NO_LENGTH && size >= m_header_size + m_content_length) {
+            m_state = COMPLETE;
+        }
+        return m_state;
+    }
+
+    // The server closed the connection after `size` bytes
+    State finish(size_t size) {
+        if (m_state == BODY && m_content_length == NO_LENGTH) {
+            m_content_length = size - m_header_size;
+            m_state = COMPLETE;
+        } else if (m_state != COMPLETE) {
+            m_state = FAILED;  // cut short
+        }
+        return m_state;
+    }
+
+    // Give up on an unfinished response (timeout, read error)
+    void fail() {
+        if (m_state != COMPLETE) m_state = FAILED;
+    }
+
+    State state() const { return m_state; }
+    bool complete() const { return m_state == COMPLETE; }
+    bool failed() const { return m_state == FAILED; }
+
+    int status() const { return m_status; }
+    size_t header_size() const { return m_header_size; }
+    size_t content_length() const { return m_content_length; }
+
+    // Total response size once the headers are in, 0 while unknown
+    size_t expected_size() const {
+        if (m_state == HEADERS || m_content_length == NO_LENGTH) return 0;
+        return m_header_size + m_content_length;
+    }
+
+private:
+    static bool header_is(const char* line, const char* colon, const char* name) {
+        size_t len = strlen(name);
+        return size_t(colon - line) == len && strncasecmp(line, name, len) == 0;
+    }
+
+    bool parse_headers(const char* data, size_t size) {
+        const char* end = data + size;
+
+        // HTTP/1.x SSS Reason
+        if (size < 12 || memcmp(data, "HTTP/1.", 7) != 0 || data[8] != ' ') return false;
+        m_status = 0;
+        for (int i = 9; i < 12; i++) {
+            if (data[i] < '0' || data[i] > '9') return false;
+            m_status = m_status * 10 + (data[i] - '0');
+        }
+
+        const char* line = static_cast<const char*>(memchr(data, '\n', size)) + 1;
+        while (line < end) {
+            const char* eol = static_cast<const char*>(memchr(line, '\n', end - line));
+            if (!eol || eol - line <= 1) break;  // blank line: end of headers
+            const char* colon = static_cast<const char*>(memchr(line, ':', eol - line));
+            if (colon) {
+                const char* value = colon + 1;
+                while (value < eol && (*value == ' ' || *value == '\t')) value++;
+                if (header_is(line, colon, "Content-Length")) {
+                    char* parsed_end;
+                    unsigned long long length = strtoull(value, &parsed_end, 10);
+                    if (parsed_end == value) return false;
+                    m_content_length = static_cast<size_t>(length);
+                } else if (header_is(line, colon, "Transfer-Encoding") &&
+                           strncasecmp(value, "identity", 8) != 0) {
+                    return false;  // chunked replies are not something RealFlight sends
+                }
+            }
+            line = eol + 1;
+        }
+        return true;
+    }
+
+    State m_state = HEADERS;
+    size_t m_scanned = 0;      // bytes already searched for the header end
+    size_t m_header_size = 0;  // status line + headers + blank line
+    size_t m_content_length = NO_LENGTH;
+    int m_status = 0;
+};
+
+
+// One response read straight off a socket: a growable buffer kept from one
+// request to the next (it only ever grows, so a steady stream of replies
+// reuses the same memory) plus its HttpResponseParser.
+//
+//   r.reset();
+//   while (!r.complete() && !r.failed()) {
+//       size_t space;
+//       char* dst = r.space(space);
+//       ssize_t n = recv(fd, dst, space, 0);
+//       n > 0 ? r.commit(n) : r.finish();
+//   }
+//   parse(r.body(), r.body_size());
+class HttpResponse {
+public:
+    static constexpr size_t INITIAL_CAPACITY = 16384;
+    static constexpr size_t MAX_SIZE = 4 << 20;  // anything bigger is not a reply we want
+
+    using State = HttpResponseParser::State;
+
+    void reset() {
+        m_size = 0;
+        m_parser.reset();
+    }
+
+    // Allocate up front so the first replies do not
+    bool reserve(size_t capacity) { return capacity <= m_capacity || grow(capacity); }
+
+    // Where the next read goes and how much it may read. Once Content-Length
+    // is known that is exactly what is left of the body. Returns nullptr
+    // (space 0) when the response would exceed MAX_SIZE.
+    char* space(size_t& avail) {
+        size_t want = m_parser.expected_size();
+        if (want == 0) {
+            // Headers (or a body without length) still coming: keep some room
+            want = m_size + 4096;
+        }
+        if (want + 1 > m_capacity && !grow(want + 1)) {
+            avail = 0;
+            return nullptr;
+        }
+        avail = (m_parser.expected_size() ? want : m_capacity - 1) - m_size;
+        return m_buffer.get() + m_size;
+    }
+
+    // `n` bytes landed where space() pointed
+    State commit(size_t n) {
+        m_size += n;
+        m_buffer[m_size] = '\0';
+        return m_parser.feed(m_buffer.get(), m_size);
+    }
+
+    // The server closed the connection
+    State finish() { return m_parser.finish(m_size); }
+
+    // Stop reading, e.g. on a timeout or a read error
+    void fail() { m_parser.fail(); }
+
+    bool complete() const { return m_parser.complete(); }
+    bool failed() const { return m_parser.failed(); }
+    int status() const { return m_parser.status(); }
+
+    // Whole response as received (for captures), NUL-terminated
+    const char* data() const { return m_buffer.get(); }
+    size_t size() const { return m_size; }
+
+    // Valid once complete()
+    const char* body() const { return m_buffer.get() + m_parser.header_size(); }
+    size_t body_size() const { return m_parser.content_length(); }
+
+private:
+    bool grow(size_t needed) {
+        if (needed > MAX_SIZE + 1) return false;
+        size_t capacity = m_capacity ? m_capacity : INITIAL_CAPACITY;
+        while (capacity < needed) capacity *= 2;
+
+        // Not a vector: growing must not zero what we are about to overwrite
+        std::unique_ptr<char[]> buffer(new char[capacity]);
+        if (m_size > 0) memcpy(buffer.get(), m_buffer.get(), m_size);
+        m_buffer = std::move(buffer);
+        m_capacity = capacity;
+        return true;
+    }
+
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_capacity = 0;
+    size_t m_size = 0;
+    HttpResponseParser m_parser;
+};
+
+} // namespace RF
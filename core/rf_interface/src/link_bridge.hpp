@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "RFInterface.hpp"
+#include "command_source.hpp"
+#include "latency_histogram.hpp"
+#include "rate_scheduler.hpp"
+#include "spsc_ring.hpp"
+#include "seqlock.hpp"
+
+namespace RF {
+
+struct BridgeStats {
+    uint64_t exchanges = 0;            // successful ExchangeData round trips
+    uint64_t failed_exchanges = 0;
+    uint64_t states_dropped = 0;       // state ring full: consumer too far behind
+    uint64_t commands_received = 0;    // set_command() calls
+    uint64_t commands_overwritten = 0; // replaced before the link sent them
+    uint64_t command_latency_p50_ns = 0; // stamp passed to set_command() -> request sent
+    uint64_t command_latency_p99_ns = 0;
+    SchedulerStats loop;               // link loop pacing and wake-up jitter
+};
+
+// Runs the RealFlight exchange loop on its own (optionally pinned, SCHED_FIFO)
+// thread and decouples it from whatever consumes the states, e.g. a ROS 2
+// executor.
+//
+// The link thread never waits on the other side: commands come in through a
+// latest-value slot (ExternalSource), states go out through an SPSC ring that drops (and
+// counts) instead of blocking when the consumer falls behind. A stalled
+// consumer therefore costs frames, never link timing.
+class LinkBridge {
+public:
+    static constexpr size_t STATE_RING_SIZE = 256;
+
+    explicit LinkBridge(RFInterface& sim, const SchedulerConfig& config = SchedulerConfig())
+        : m_sim(sim), m_scheduler(config) {}
+
+    ~LinkBridge() { stop(); }
+
+    LinkBridge(const LinkBridge&) = delete;
+    LinkBridge& operator=(const LinkBridge&) = delete;
+
+    // `sim` must already be connected
+    bool start() {
+        if (m_running.load()) return true;
+        if (!m_sim.isRFConnected()) return false;
+        m_running.store(true);
+        m_thread = std::thread(&LinkBridge::run, this);
+        return true;
+    }
+
+    void stop() {
+        m_running.store(false);
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    // Never blocks. One writer at a time (e.g. a single subscription callback).
+    // stamp_ns is when the command was produced (steady_clock, 0 = now);
+    // the time from there to its first send is tracked in stats().
+    void set_command(const RFCmd& cmd, int64_t stamp_ns = 0) {
+        m_commands.set_command(cmd, stamp_ns);
+    }
+
+    // Consumer thread only: next state in arrival order
+    bool pop_state(StateSnapshot& out) {
+        return m_states.pop(out);
+    }
+
+    // Consumer thread only: sleep until a state is queued or timeout_ms
+    // passes. Returns false on timeout.
+    bool wait_state(int timeout_ms) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (true) {
+            // Read the signal before checking, so a push in between bumps it
+            // and the wait below returns immediately
+            uint64_t seen = m_pushed.version();
+            if (m_states.size() > 0) return true;
+
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0) return false;
+            m_pushed.wait_for_update(seen, static_cast<int>(left));
+        }
+    }
+
+    BridgeStats stats() const {
+        BridgeStats s;
+        s.exchanges = m_exchanges.load(std::memory_order_relaxed);
+        s.failed_exchanges = m_failed.load(std::memory_order_relaxed);
+        s.states_dropped = m_states.dropped();
+        s.commands_received = m_commands.commands();
+        s.commands_overwritten = m_overwritten.load(std::memory_order_relaxed);
+        s.loop = m_scheduler.stats();
+        s.command_latency_p50_ns = m_command_latency.percentile(50);
+        s.command_latency_p99_ns = m_command_latency.percentile(99);
+        return s;
+    }
+
+private:
+    void run() {
+        m_scheduler.apply_realtime();
+        m_scheduler.start();
+
+        uint64_t last_version = 0;
+        uint64_t last_frame = m_sim.frames_received();
+        while (m_running.load()) {
+            TimedCommand cmd;
+            uint64_t version = m_commands.load(cmd);
+            if (version > last_version + 1) {
+                m_overwritten.fetch_add(version - last_version - 1, std::memory_order_relaxed);
+            }
+            if (version != last_version && cmd.stamp_ns != 0) {
+                int64_t age = RateScheduler::now_ns() - cmd.stamp_ns;
+                m_command_latency.record(age > 0 ? static_cast<uint64_t>(age) : 0);
+            }
+            last_version = version;
+
+            if (m_sim.exchange_data(cmd.cmd)) {
+                m_exchanges.fetch_add(1, std::memory_order_relaxed);
+                // Only new physics steps, not repeats of the last one
+                if (m_sim.frames_received() != last_frame) {
+                    StateSnapshot snap = m_sim.get_state();
+                    last_frame = snap.frame;
+                    if (m_states.push(snap)) m_pushed.store(m_states.pushed());
+                }
+            } else {
+                m_failed.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_scheduler.wait_next();
+        }
+    }
+
+    RFInterface& m_sim;
+    RateScheduler m_scheduler;
+
+    ExternalSource m_commands;
+    LatencyHistogram m_command_latency;
+    SpscRing<StateSnapshot, STATE_RING_SIZE> m_states;
+    SeqLock<uint64_t> m_pushed;  // stored after each push: wakes wait_state()
+
+    std::atomic_bool m_running{false};
+    std::thread m_thread;
+    std::atomic<uint64_t> m_exchanges{0};
+    std::atomic<uint64_t> m_failed{0};
+    std::atomic<uint64_t> m_overwritten{0};
+};
+
+} // namespace RF
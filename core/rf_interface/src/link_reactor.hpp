@@ -0,0 +1,305 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "async_log.hpp"
+
+namespace RF {
+
+// Something run by a LinkReactor. Both callbacks run on the reactor thread,
+// one at a time across all clients, and must never block.
+class ReactorClient {
+public:
+    virtual ~ReactorClient() = default;
+
+    // An fd registered with LinkReactor::watch() is ready. May be called once
+    // more for an fd that was just unwatched, so tolerate EAGAIN. Return true
+    // to have on_timer() run right away (e.g. a slot was freed).
+    virtual bool on_event(int fd, uint32_t events) = 0;
+
+    // Runs after attach(), after wake(), when asked by on_event() and when
+    // the deadline it returned last time (steady clock ns) has passed.
+    // Return 0 when nothing is due until the next event or wake.
+    virtual int64_t on_timer(int64_t now_ns) = 0;
+};
+
+// One epoll event loop thread shared by any number of links: SocketPool
+// connects, and the sends and receives of RFInterface instances running in
+// reactor mode. Client deadlines are served from a single timerfd, so pacing
+// is as precise as the clock, not epoll's millisecond timeout.
+//
+// shared() hands out a process-wide instance that is created on first use
+// and destroyed with its last user.
+class LinkReactor {
+public:
+    LinkReactor() {
+        m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        m_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (m_epoll_fd < 0 || m_wake_fd < 0 || m_timer_fd < 0) {
+            RF_LOG_ERROR("LinkReactor: setup failed: %s", strerror(errno));
+            return;
+        }
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = m_wake_fd;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &ev);
+        ev.data.fd = m_timer_fd;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_timer_fd, &ev);
+
+        m_running.store(true);
+        m_thread = std::thread(&LinkReactor::run, this);
+    }
+
+    ~LinkReactor() {
+        m_running.store(false);
+        notify();
+        if (m_thread.joinable()) m_thread.join();
+        if (m_timer_fd >= 0) close(m_timer_fd);
+        if (m_wake_fd >= 0) close(m_wake_fd);
+        if (m_epoll_fd >= 0) close(m_epoll_fd);
+    }
+
+    LinkReactor(const LinkReactor&) = delete;
+    LinkReactor& operator=(const LinkReactor&) = delete;
+
+    static std::shared_ptr<LinkReactor> shared() {
+        static std::mutex s_mutex;
+        static std::weak_ptr<LinkReactor> s_reactor;
+
+        std::lock_guard<std::mutex> lock(s_mutex);
+        std::shared_ptr<LinkReactor> reactor = s_reactor.lock();
+        if (!reactor) {
+            reactor = std::make_shared<LinkReactor>();
+            s_reactor = reactor;
+        }
+        return reactor;
+    }
+
+    bool ok() const { return m_running.load(); }
+
+    // Any thread. The client's on_timer() runs shortly after.
+    void attach(ReactorClient* client) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_attach.push_back(client);
+        }
+        notify();
+    }
+
+    // Any thread, including the client's own callbacks. Once it returns no
+    // callback of `client` is running or will run again, and its fds are no
+    // longer watched (they are not closed).
+    void detach(ReactorClient* client) {
+        if (in_loop() || !m_running.load()) {
+            drop(client);
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_detach.push_back(client);
+        uint64_t target = ++m_detach_requested;
+        notify();
+        m_detached_cv.wait(lock, [&] { return m_detach_done >= target || !m_running.load(); });
+    }
+
+    // Any thread: run the client's on_timer() on the next loop iteration
+    void wake(ReactorClient* client) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_wakeups.push_back(client);
+        }
+        notify();
+    }
+
+    // Reactor thread only (i.e. from the callbacks)
+    void watch(int fd, uint32_t events, ReactorClient* client) {
+        struct epoll_event ev;
+        ev.events = events;
+        ev.data.fd = fd;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0) {
+            m_watched[fd] = client;
+        }
+    }
+
+    void unwatch(int fd) {
+        if (m_watched.erase(fd)) {
+            epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        }
+    }
+
+    bool in_loop() const { return std::this_thread::get_id() == m_thread.get_id(); }
+
+private:
+    struct Client {
+        ReactorClient* client;
+        int64_t deadline_ns;  // 0 = none
+    };
+
+    static int64_t now_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return int64_t(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    }
+
+    void notify() {
+        uint64_t one = 1;
+        ssize_t n = write(m_wake_fd, &one, sizeof(one));
+        (void)n;
+    }
+
+    // Reactor thread (or no thread at all)
+    void drop(ReactorClient* client) {
+        m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(),
+                                       [client](const Client& c) { return c.client == client; }),
+                        m_clients.end());
+        for (auto it = m_watched.begin(); it != m_watched.end();) {
+            if (it->second == client) {
+                epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, it->first, nullptr);
+                it = m_watched.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    Client* find(ReactorClient* client) {
+        for (Client& c : m_clients) {
+            if (c.client == client) return &c;
+        }
+        return nullptr;
+    }
+
+    // Attach, detach and wake requests from other threads
+    void apply_requests(int64_t now) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (ReactorClient* client : m_attach) {
+            if (!find(client)) m_clients.push_back({client, now});
+        }
+        m_attach.clear();
+
+        for (ReactorClient* client : m_wakeups) {
+            if (Client* c = find(client)) c->deadline_ns = now;
+        }
+        m_wakeups.clear();
+
+        if (!m_detach.empty()) {
+            for (ReactorClient* client : m_detach) drop(client);
+            m_detach.clear();
+            m_detach_done = m_detach_requested;
+            m_detached_cv.notify_all();
+        }
+    }
+
+    // Run the due timers; returns the earliest remaining deadline, 0 if none
+    int64_t run_timers() {
+        int64_t next = 0;
+        // Index loop: a callback may detach itself (or another client)
+        for (size_t i = 0; i < m_clients.size(); i++) {
+            int64_t now = now_ns();
+            if (m_clients[i].deadline_ns != 0 && m_clients[i].deadline_ns <= now) {
+                ReactorClient* client = m_clients[i].client;
+                int64_t deadline = client->on_timer(now);
+                if (i < m_clients.size() && m_clients[i].client == client) {
+                    m_clients[i].deadline_ns = deadline;
+                }
+            }
+            if (i < m_clients.size() && m_clients[i].deadline_ns != 0) {
+                next = next == 0 ? m_clients[i].deadline_ns : std::min(next, m_clients[i].deadline_ns);
+            }
+        }
+        return next;
+    }
+
+    void arm_timer(int64_t deadline_ns) {
+        if (deadline_ns == m_armed_ns) return;
+        struct itimerspec its;
+        memset(&its, 0, sizeof(its));
+        its.it_value.tv_sec = deadline_ns / 1000000000LL;
+        its.it_value.tv_nsec = deadline_ns % 1000000000LL;
+        timerfd_settime(m_timer_fd, TFD_TIMER_ABSTIME, &its, nullptr);  // 0 disarms
+        m_armed_ns = deadline_ns;
+    }
+
+    void run() {
+        struct epoll_event events[64];
+        while (m_running.load()) {
+            apply_requests(now_ns());
+
+            int64_t next = run_timers();
+            int timeout = -1;
+            if (next != 0 && next <= now_ns()) {
+                timeout = 0;  // something became due while the timers ran
+            } else {
+                arm_timer(next);
+            }
+
+            int n = epoll_wait(m_epoll_fd, events, 64, timeout);
+            if (n < 0 && errno != EINTR) {
+                RF_LOG_ERROR("LinkReactor: epoll_wait failed: %s", strerror(errno));
+                break;
+            }
+
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                if (fd == m_wake_fd || fd == m_timer_fd) {
+                    uint64_t count;
+                    ssize_t r = read(fd, &count, sizeof(count));
+                    (void)r;
+                    if (fd == m_timer_fd) m_armed_ns = 0;
+                    continue;
+                }
+
+                auto it = m_watched.find(fd);
+                if (it == m_watched.end()) continue;
+                ReactorClient* client = it->second;
+                if (client->on_event(fd, events[i].events)) {
+                    if (Client* c = find(client)) c->deadline_ns = now_ns();
+                }
+            }
+        }
+
+        // Release anyone still waiting in detach()
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_detach_done = m_detach_requested;
+        m_detached_cv.notify_all();
+    }
+
+    int m_epoll_fd = -1;
+    int m_wake_fd = -1;   // eventfd: requests from other threads
+    int m_timer_fd = -1;  // earliest client deadline
+    int64_t m_armed_ns = 0;
+
+    // Reactor thread only
+    std::vector<Client> m_clients;
+    std::unordered_map<int, ReactorClient*> m_watched;
+
+    std::mutex m_mutex;
+    std::vector<ReactorClient*> m_attach;
+    std::vector<ReactorClient*> m_detach;
+    std::vector<ReactorClient*> m_wakeups;
+    uint64_t m_detach_requested = 0;
+    uint64_t m_detach_done = 0;
+    std::condition_variable m_detached_cv;
+
+    std::atomic_bool m_running{false};
+    std::thread m_thread;
+};
+
+} // namespace RF
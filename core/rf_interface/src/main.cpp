@@ -4,6 +4,7 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <memory>
 #include <signal.h>
 
 using namespace RF;
@@ -21,7 +22,12 @@ int main(int argc, char* argv[]) {
     signal(SIGTERM, signal_handler);
     
     // Create RF interface with Joystick 
-    RFInterface sim("172.19.112.1", 18083);
+    RFInterface sim("172.19.112.1", 18083, false);
+    sim.set_command_source(std::make_unique<JoystickSource>("/dev/input/event0"));
+    if (!sim.start()) {
+        std::cout << "[ERROR] RFInterface Initialization Failed" << std::endl;
+        return 1;
+    }
     
     while (running) {              
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <atomic>
+
+#include "async_log.hpp"
+
+namespace RF {
+
+struct SchedulerConfig {
+    double rate_hz = 0.0;      // loop rate; 0 = free-running (no pacing)
+    int fifo_priority = 0;     // > 0: run the loop thread SCHED_FIFO at this priority
+    int cpu = -1;              // >= 0: pin the loop thread to this CPU
+    bool lock_memory = false;  // mlockall() so the loop never page-faults
+};
+
+struct SchedulerStats {
+    uint64_t cycles = 0;          // periods completed
+    uint64_t overruns = 0;        // cycles whose work ran past the next deadline
+    uint64_t missed_periods = 0;  // deadlines skipped because of overruns
+    int64_t max_jitter_ns = 0;    // worst wake-up lateness
+    int64_t mean_jitter_ns = 0;
+};
+
+// Fixed-rate pacing on absolute CLOCK_MONOTONIC deadlines.
+//
+// Deadlines advance by exactly one period each cycle, so sleep and wake-up
+// latency never accumulate into drift. After an overrun the missed deadlines
+// are skipped rather than run back to back.
+class RateScheduler {
+public:
+    explicit RateScheduler(const SchedulerConfig& config = SchedulerConfig()) {
+        configure(config);
+    }
+
+    // Not thread safe against a running loop
+    void configure(const SchedulerConfig& config) {
+        m_config = config;
+        m_period_ns = config.rate_hz > 0.0 ? static_cast<int64_t>(1e9 / config.rate_hz) : 0;
+    }
+
+    bool enabled() const { return m_period_ns > 0; }
+    int64_t period_ns() const { return m_period_ns; }
+
+    // Apply priority, affinity and memory locking to the calling thread.
+    // Each failure is logged; returns false if any of them failed.
+    bool apply_realtime() {
+        bool ok = true;
+        if (!m_config.lock_memory && m_config.cpu < 0 && m_config.fifo_priority <= 0) return ok;
+
+        if (m_config.lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            RF_LOG_ERROR("RateScheduler: mlockall failed: %s", strerror(errno));
+            ok = false;
+        }
+
+        if (m_config.cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(m_config.cpu, &set);
+            int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            if (err != 0) {
+                RF_LOG_ERROR("RateScheduler: cannot pin to CPU %d: %s", m_config.cpu, strerror(err));
+                ok = false;
+            }
+        }
+
+        if (m_config.fifo_priority > 0) {
+            struct sched_param param;
+            param.sched_priority = m_config.fifo_priority;
+            int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+            if (err != 0) {
+                RF_LOG_ERROR("RateScheduler: SCHED_FIFO %d failed: %s", m_config.fifo_priority, strerror(err));
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    // First deadline is one period from now
+    void start() {
+        m_deadline_ns = now_ns() + m_period_ns;
+    }
+
+    // Sleep until the next deadline. Call once per cycle after the work.
+    void wait_next() {
+        if (!enabled()) return;
+
+        skip_overrun(now_ns());
+
+        struct timespec ts = to_timespec(m_deadline_ns);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+
+        finish_cycle(now_ns());
+    }
+
+    // Non-blocking variant for loops that wait on something else (e.g. poll).
+    // Returns true once per period when the deadline has passed.
+    bool tick() {
+        if (!enabled()) return true;
+
+        int64_t now = now_ns();
+        if (now < m_deadline_ns) return false;
+
+        finish_cycle(now);
+        skip_overrun(now);
+        return true;
+    }
+
+    // Time left until the next deadline, for poll/ppoll timeouts
+    int64_t ns_until_deadline() const {
+        if (!enabled()) return 0;
+        int64_t left = m_deadline_ns - now_ns();
+        return left > 0 ? left : 0;
+    }
+
+    SchedulerStats stats() const {
+        SchedulerStats s;
+        s.cycles = m_cycles.load(std::memory_order_relaxed);
+        s.overruns = m_overruns.load(std::memory_order_relaxed);
+        s.missed_periods = m_missed.load(std::memory_order_relaxed);
+        s.max_jitter_ns = m_max_jitter_ns.load(std::memory_order_relaxed);
+        s.mean_jitter_ns = s.cycles ? m_total_jitter_ns.load(std::memory_order_relaxed) / int64_t(s.cycles) : 0;
+        return s;
+    }
+
+    static int64_t now_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return int64_t(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    }
+
+private:
+    static struct timespec to_timespec(int64_t ns) {
+        struct timespec ts;
+        ts.tv_sec = ns / 1000000000LL;
+        ts.tv_nsec = ns % 1000000000LL;
+        return ts;
+    }
+
+    // Work already ran past the deadline: count it and move the deadline to
+    // the next one still in the future
+    void skip_overrun(int64_t now) {
+        if (now < m_deadline_ns) return;
+
+        int64_t behind = (now - m_deadline_ns) / m_period_ns + 1;
+        m_overruns.fetch_add(1, std::memory_order_relaxed);
+        m_missed.fetch_add(behind - 1, std::memory_order_relaxed);
+        m_deadline_ns += behind * m_period_ns;
+    }
+
+    void finish_cycle(int64_t woke) {
+        int64_t jitter = woke - m_deadline_ns;
+        if (jitter < 0) jitter = 0;
+
+        m_cycles.fetch_add(1, std::memory_order_relaxed);
+        m_total_jitter_ns.fetch_add(jitter, std::memory_order_relaxed);
+        if (jitter > m_max_jitter_ns.load(std::memory_order_relaxed)) {
+            m_max_jitter_ns.store(jitter, std::memory_order_relaxed);
+        }
+        m_deadline_ns += m_period_ns;
+    }
+
+    SchedulerConfig m_config;
+    int64_t m_period_ns = 0;
+    int64_t m_deadline_ns = 0;
+
+    // Written by the loop thread only, readable from anywhere
+    std::atomic<uint64_t> m_cycles{0};
+    std::atomic<uint64_t> m_overruns{0};
+    std::atomic<uint64_t> m_missed{0};
+    std::atomic<int64_t> m_max_jitter_ns{0};
+    std::atomic<int64_t> m_total_jitter_ns{0};
+};
+
+} // namespace RF
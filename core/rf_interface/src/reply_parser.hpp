@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <charconv>
+
+#include "telemetry_schema.hpp"
+
+namespace RF {
+
+namespace detail {
+
+constexpr size_t const_strlen(const char* s) {
+    size_t n = 0;
+    while (s[n]) n++;
+    return n;
+}
+
+// FNV-1a, seeded. Cheap enough to run byte by byte while scanning a tag name.
+constexpr uint32_t tag_hash_init(uint32_t seed) {
+    return 2166136261u ^ seed;
+}
+
+constexpr uint32_t tag_hash_step(uint32_t h, char c) {
+    return (h ^ static_cast<uint8_t>(c)) * 16777619u;
+}
+
+constexpr uint32_t tag_hash(const char* s, size_t len, uint32_t seed) {
+    uint32_t h = tag_hash_init(seed);
+    for (size_t i = 0; i < len; i++) h = tag_hash_step(h, s[i]);
+    return h;
+}
+
+// Collision-free slot table for telemetry_schema tags, found at compile time by
+// trying seeds until every tag lands in its own slot
+struct TagTable {
+    static constexpr uint32_t SIZE = 256;  // power of two, ~5x the key count
+    static constexpr uint32_t MASK = SIZE - 1;
+    static constexpr int EMPTY = -1;
+
+    uint32_t seed = 0;
+    int16_t slot[SIZE] = {};
+    uint8_t length[NUM_TELEMETRY_TAGS] = {};
+};
+
+constexpr TagTable make_tag_table() {
+    TagTable table;
+    for (int i = 0; i < NUM_TELEMETRY_TAGS; i++) {
+        table.length[i] = static_cast<uint8_t>(const_strlen(telemetry_schema[i].tag));
+    }
+
+    for (uint32_t seed = 0; seed < 100000; seed++) {
+        for (uint32_t s = 0; s < TagTable::SIZE; s++) table.slot[s] = TagTable::EMPTY;
+
+        bool ok = true;
+        for (int i = 0; i < NUM_TELEMETRY_TAGS && ok; i++) {
+            uint32_t s = tag_hash(telemetry_schema[i].tag, table.length[i], seed) & TagTable::MASK;
+            if (table.slot[s] != TagTable::EMPTY) {
+                ok = false;
+            } else {
+                table.slot[s] = static_cast<int16_t>(i);
+            }
+        }
+        if (ok) {
+            table.seed = seed;
+            return table;
+        }
+    }
+    table.seed = UINT32_MAX;
+    return table;
+}
+
+static constexpr TagTable tag_table = make_tag_table();
+static_assert(tag_table.seed != UINT32_MAX, "no perfect hash seed found for telemetry_schema");
+
+// Text between '>' and '<'. Booleans map to 1/0, anything unparsable to 0.
+inline double decode_value(const char* begin, const char* end) {
+    size_t len = end - begin;
+    if (len == 4 && memcmp(begin, "true", 4) == 0) return 1.0;
+    if (len == 5 && memcmp(begin, "false", 5) == 0) return 0.0;
+
+    double value = 0.0;
+    auto result = std::from_chars(begin, end, value);
+    if (result.ec != std::errc()) return 0.0;
+    return value;
+}
+
+} // namespace detail
+
+// Single pass over an ExchangeData reply.
+//
+// Walks the buffer once, hashing each element name as it is read and
+// resolving it against the compile-time tag table. Calls
+//   on_item(index, value)   for each <item>, in document order
+//   on_field(index, value)  for each telemetry_schema[index]
+// Only the parts in `wanted` are decoded: other tags are skipped without
+// converting their text, and the scan stops as soon as every wanted value
+// has been seen. Returns the number of values decoded. Never allocates.
+template <typename ItemFn, typename FieldFn>
+inline int scan_reply(const char* p, const char* end, ItemFn&& on_item, FieldFn&& on_field,
+                      TelemetryMask wanted = TELEMETRY_ALL) {
+    using detail::tag_table;
+    using detail::TagTable;
+
+    int decoded = 0;
+    int items = 0;
+    const bool want_items = (wanted & TELEMETRY_RCIN) != 0;
+    TelemetryMask pending = wanted & TELEMETRY_TAGS_ALL;
+
+    while (p < end && (pending != 0 || (want_items && items < NUM_RCIN))) {
+        p = static_cast<const char*>(memchr(p, '<', end - p));
+        if (!p) break;
+        p++;
+
+        // Closing tags, <?xml ... ?> and the like carry no values
+        if (p >= end || *p == '/' || *p == '?' || *p == '!') continue;
+
+        const char* name = p;
+        uint32_t h = detail::tag_hash_init(tag_table.seed);
+        while (p < end && *p != '>' && *p != ' ' && *p != '/' && *p != '\t') {
+            h = detail::tag_hash_step(h, *p);
+            p++;
+        }
+        size_t name_len = p - name;
+
+        // Skip attributes up to the end of the start tag
+        while (p < end && *p != '>') p++;
+        if (p >= end) break;
+        if (p[-1] == '/') continue;  // <empty/>
+        const char* value = ++p;
+
+        int field = -1;
+        bool is_item = false;
+        if (name_len == 4 && memcmp(name, "item", 4) == 0) {
+            is_item = want_items;
+        } else {
+            int idx = tag_table.slot[h & TagTable::MASK];
+            if (idx != TagTable::EMPTY && (wanted & (uint64_t(1) << idx)) &&
+                tag_table.length[idx] == name_len &&
+                memcmp(name, telemetry_schema[idx].tag, name_len) == 0) {
+                field = idx;
+            }
+        }
+        if (!is_item && field < 0) continue;
+
+        const char* value_end = static_cast<const char*>(memchr(value, '<', end - value));
+        if (!value_end) break;
+
+        double v = detail::decode_value(value, value_end);
+        if (is_item) {
+            if (items < NUM_RCIN) on_item(items++, v);
+        } else {
+            on_field(field, v);
+            pending &= ~(uint64_t(1) << field);
+        }
+        decoded++;
+        p = value_end;
+    }
+    return decoded;
+}
+
+// m-currentPhysicsTime-SEC without decoding the rest of the reply.
+// Returns -1 if the tag is missing.
+inline double peek_physics_time(const char* p, const char* end) {
+    static constexpr char tag[] = "<m-currentPhysicsTime-SEC>";
+    const char* start = static_cast<const char*>(memmem(p, end - p, tag, sizeof(tag) - 1));
+    if (!start) return -1.0;
+    start += sizeof(tag) - 1;
+
+    const char* value_end = static_cast<const char*>(memchr(start, '<', end - start));
+    if (!value_end) return -1.0;
+    return detail::decode_value(start, value_end);
+}
+
+} // namespace RF
@@ -0,0 +1,166 @@
+// Offline reader for flight logs written by RFInterface::start_recording()
+//
+//   rf_log_dump <log>                        summary
+//   rf_log_dump <log> --cmd cmd.csv          commands as CSV ("-" = stdout)
+//   rf_log_dump <log> --state state.csv      states as CSV ("-" = stdout)
+
+#include <cstdio>
+#include <cstring>
+#include <cinttypes>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "RFInterface.hpp"
+
+using namespace RF;
+
+static void usage() {
+    fprintf(stderr, "usage: rf_log_dump <log> [--cmd FILE] [--state FILE]\n");
+}
+
+static FILE* open_output(const char* path) {
+    if (strcmp(path, "-") == 0) return stdout;
+    FILE* f = fopen(path, "w");
+    if (!f) perror(path);
+    return f;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    const char* log_path = argv[1];
+    const char* cmd_path = nullptr;
+    const char* state_path = nullptr;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--cmd") == 0 && i + 1 < argc) {
+            cmd_path = argv[++i];
+        } else if (strcmp(argv[i], "--state") == 0 && i + 1 < argc) {
+            state_path = argv[++i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    int fd = open(log_path, O_RDONLY);
+    if (fd < 0) {
+        perror(log_path);
+        return 1;
+    }
+    struct stat st;
+    fstat(fd, &st);
+    if (size_t(st.st_size) < FLIGHT_LOG_HEADER_SIZE) {
+        fprintf(stderr, "[ERROR] %s: too short for a flight log\n", log_path);
+        return 1;
+    }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    const auto* base = static_cast<const unsigned char*>(map);
+    const auto* header = reinterpret_cast<const FlightLogHeader*>(base);
+    const auto* records = reinterpret_cast<const FlightRecord*>(base + FLIGHT_LOG_HEADER_SIZE);
+
+    if (memcmp(header->magic, FLIGHT_LOG_MAGIC, sizeof(FLIGHT_LOG_MAGIC)) != 0 ||
+        header->version != FLIGHT_LOG_VERSION || header->record_size != sizeof(FlightRecord)) {
+        fprintf(stderr, "[ERROR] %s: not a version %u flight log\n", log_path, FLIGHT_LOG_VERSION);
+        return 1;
+    }
+    if (FLIGHT_LOG_HEADER_SIZE + header->capacity * sizeof(FlightRecord) > size_t(st.st_size)) {
+        fprintf(stderr, "[ERROR] %s: truncated (capacity %" PRIu64 ")\n", log_path, header->capacity);
+        return 1;
+    }
+    if (header->cmd_size != sizeof(RFCmd) || header->state_size != sizeof(AircraftState)) {
+        fprintf(stderr, "[ERROR] %s: written with a different RFCmd/AircraftState layout\n", log_path);
+        return 1;
+    }
+
+    // Valid records, oldest first. Slots being rewritten when the writer
+    // stopped have seq 0 or a seq from the previous lap and are skipped.
+    uint64_t written = header->written;
+    uint64_t first = written > header->capacity ? written - header->capacity : 0;
+    std::vector<const FlightRecord*> valid;
+    valid.reserve(written - first);
+    uint64_t torn = 0;
+    for (uint64_t n = first; n < written; n++) {
+        const FlightRecord& r = records[n % header->capacity];
+        if (r.seq == n + 1) {
+            valid.push_back(&r);
+        } else {
+            torn++;
+        }
+    }
+
+    if (!cmd_path && !state_path) {
+        uint64_t cmds = 0, states = 0;
+        for (const FlightRecord* r : valid) {
+            if (r->type == RECORD_CMD) cmds++;
+            if (r->type == RECORD_STATE) states++;
+        }
+        double span_s = valid.empty() ? 0.0 : (valid.back()->host_time_ns - valid.front()->host_time_ns) / 1e9;
+        printf("records written  : %" PRIu64 " (ring capacity %" PRIu64 ")\n", written, header->capacity);
+        printf("records readable : %zu (%" PRIu64 " overwritten, %" PRIu64 " torn)\n", valid.size(), first, torn);
+        printf("commands         : %" PRIu64 "\n", cmds);
+        printf("states           : %" PRIu64 "\n", states);
+        printf("span             : %.3f s\n", span_s);
+        if (span_s > 0) printf("state rate       : %.1f Hz\n", states / span_s);
+        return 0;
+    }
+
+    // Host times are written as steady_clock ns and as wall-clock seconds
+    auto wall_s = [&](int64_t host_ns) {
+        return (header->realtime_origin_ns + (host_ns - header->steady_origin_ns)) / 1e9;
+    };
+
+    if (cmd_path) {
+        FILE* out = open_output(cmd_path);
+        if (!out) return 1;
+        fprintf(out, "seq,host_time_ns,wall_time_s,frame,throttle,aileron,elevator,rudder,flaps,gear,event_time_ns\n");
+        for (const FlightRecord* r : valid) {
+            if (r->type != RECORD_CMD) continue;
+            RFCmd cmd;
+            memcpy(&cmd, r->payload, sizeof(cmd));
+            fprintf(out, "%" PRIu64 ",%" PRId64 ",%.6f,%" PRIu64 ",%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%" PRId64 "\n",
+                    r->seq - 1, r->host_time_ns, wall_s(r->host_time_ns), r->frame,
+                    cmd.throttle, cmd.aileron, cmd.elevator, cmd.rudder, cmd.flaps, cmd.gear, cmd.event_time_ns);
+        }
+        if (out != stdout) fclose(out);
+    }
+
+    if (state_path) {
+        FILE* out = open_output(state_path);
+        if (!out) return 1;
+
+        // AircraftState is rcin[] followed by the telemetry_schema fields, all doubles
+        fprintf(out, "seq,host_time_ns,wall_time_s,frame");
+        for (int i = 0; i < NUM_RCIN; i++) fprintf(out, ",rcin%d", i);
+        for (int i = 0; i < NUM_TELEMETRY_TAGS; i++) fprintf(out, ",%s", telemetry_schema[i].tag);
+        fprintf(out, "\n");
+
+        double values[NUM_RCIN + NUM_TELEMETRY_TAGS];
+        static_assert(sizeof(values) == sizeof(AircraftState), "AircraftState layout changed");
+        for (const FlightRecord* r : valid) {
+            if (r->type != RECORD_STATE) continue;
+            memcpy(values, r->payload, sizeof(values));
+            fprintf(out, "%" PRIu64 ",%" PRId64 ",%.6f,%" PRIu64,
+                    r->seq - 1, r->host_time_ns, wall_s(r->host_time_ns), r->frame);
+            for (double v : values) fprintf(out, ",%.10g", v);
+            fprintf(out, "\n");
+        }
+        if (out != stdout) fclose(out);
+    }
+
+    munmap(map, st.st_size);
+    close(fd);
+    return 0;
+}
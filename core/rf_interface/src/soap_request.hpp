@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+#include <charconv>
+
+namespace RF {
+
+// Precomputed HTTP + SOAP request for ExchangeData.
+//
+// The whole request (headers, envelope, <pControlInputs>) is laid out once in
+// a fixed buffer. Every channel value is written with a fixed width of
+// CHANNEL_WIDTH characters ("0.500000"), so the body length and therefore
+// Content-Length never change and the only per-frame work is twelve
+// std::to_chars calls into known offsets. No heap allocation, no copies.
+class ExchangeRequest {
+public:
+    static constexpr int NUM_CHANNELS = 12;
+    static constexpr int CHANNEL_PRECISION = 6;
+    static constexpr int CHANNEL_WIDTH = 2 + CHANNEL_PRECISION;  // "d.dddddd"
+
+    ExchangeRequest() {
+        static const char* envelope_head =
+            "<?xml version='1.0' encoding='UTF-8'?>"
+            "<soap:Envelope xmlns:soap='http://schemas.xmlsoap.org/soap/envelope/' "
+            "xmlns:xsd='http://www.w3.org/2001/XMLSchema' "
+            "xmlns:xsi='http://www.w3.org/2001/XMLSchema-instance'>"
+            "<soap:Body>"
+            "<ExchangeData>"
+            "<pControlInputs>"
+            "<m-selectedChannels>4095</m-selectedChannels>"
+            "<m-channelValues-0to1>";
+        static const char* envelope_tail =
+            "</m-channelValues-0to1>"
+            "</pControlInputs>"
+            "</ExchangeData>"
+            "</soap:Body>"
+            "</soap:Envelope>";
+
+        // Body length is fixed: head + 12 * <item>d.dddddd</item> + tail
+        size_t body_len = strlen(envelope_head) + strlen(envelope_tail) +
+                          NUM_CHANNELS * (strlen("<item></item>") + CHANNEL_WIDTH);
+
+        int n = snprintf(m_buffer, sizeof(m_buffer),
+                         "POST / HTTP/1.1\r\n"
+                         "Soapaction: 'ExchangeData'\r\n"
+                         "Content-Length: %zu\r\n"
+                         "Content-Type: text/xml;charset=utf-8\r\n"
+                         "\r\n"
+                         "%s", body_len, envelope_head);
+        size_t len = static_cast<size_t>(n);
+
+        for (int i = 0; i < NUM_CHANNELS; i++) {
+            len += append(len, "<item>");
+            m_slots[i] = len;
+            memset(m_buffer + len, '0', CHANNEL_WIDTH);
+            len += CHANNEL_WIDTH;
+            len += append(len, "</item>");
+        }
+        len += append(len, envelope_tail);
+        m_length = len;
+    }
+
+    // Write channel values (clamped to [0, 1]) into their slots
+    void set_channels(const double (&channels)[NUM_CHANNELS]) {
+        for (int i = 0; i < NUM_CHANNELS; i++) {
+            double v = channels[i];
+            if (!(v >= 0.0)) v = 0.0;  // also catches NaN
+            if (v > 1.0) v = 1.0;
+            char* slot = m_buffer + m_slots[i];
+            std::to_chars(slot, slot + CHANNEL_WIDTH, v, std::chars_format::fixed, CHANNEL_PRECISION);
+        }
+    }
+
+    const char* data() const { return m_buffer; }
+    size_t size() const { return m_length; }
+
+private:
+    size_t append(size_t at, const char* s) {
+        size_t n = strlen(s);
+        memcpy(m_buffer + at, s, n);
+        return n;
+    }
+
+    char m_buffer[1024];
+    size_t m_slots[NUM_CHANNELS];
+    size_t m_length = 0;
+};
+
+} // namespace RF
@@ -1,121 +1,284 @@
+#pragma once
+
 #include <cstring>
 #include <cstdio>
 #include <cstdarg>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <errno.h>
-#include <sys/select.h>
+#include <poll.h>
 
+#include <algorithm>
+#include <memory>
 #include <queue>
-#include <thread>
+#include <vector>
+#include <unordered_map>
 #include <mutex>
+#include <condition_variable>
 #include <chrono>
-#include <iostream>
-#include <sstream>
 
-// Connection pool for managing sockets- Realflight does not allow using the same socket 
+#include "async_log.hpp"
+#include "link_reactor.hpp"
+
+// Connection pool for managing sockets- Realflight does not allow using the same socket
 // for multiple SOAP requests according to docs floating around online
-class SocketPool {
+//
+// Keeps up to pool_size sockets pre-connected to one server. Connects are
+// non-blocking and completed on a LinkReactor thread, which any number of
+// pools (one per server) share; the pool is idle while full and woken when
+// get_socket() takes a socket. While the server is unreachable, retries back
+// off exponentially.
+class SocketPool : private RF::ReactorClient {
 public:
-    SocketPool(const char* ip, uint16_t port, size_t pool_size = 5) 
-        : server_ip(ip), server_port(port), max_pool_size(pool_size), shutdown_flag(false) {
-        // Start background thread to create connections
-        pool_thread = std::thread(&SocketPool::maintain_pool, this);
-        
-        // Wait for initial connections
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    SocketPool(const char* ip, uint16_t port, size_t pool_size = 5,
+               std::shared_ptr<RF::LinkReactor> reactor = nullptr)
+        : server_ip(ip), server_port(port), max_pool_size(pool_size),
+          reactor(reactor ? std::move(reactor) : RF::LinkReactor::shared()), shutdown_flag(false) {
+        memset(&server_addr, 0, sizeof(server_addr));
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(server_port);
+        address_ok = inet_pton(AF_INET, server_ip, &server_addr.sin_addr) > 0;
+        if (!address_ok) {
+            RF_LOG_ERROR("SocketPool: Invalid address: %s", server_ip);
+        }
+
+        // Connections are made on the reactor thread
+        this->reactor->attach(this);
+
+        // Wait (briefly) for the first connection
+        std::unique_lock<std::mutex> lock(pool_mutex);
+        ready_cv.wait_for(lock, std::chrono::milliseconds(100),
+                          [this] { return !available_sockets.empty(); });
     }
-    
+
     ~SocketPool() {
-        shutdown_flag = true;
-        if (pool_thread.joinable()) {
-            pool_thread.join();
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            shutdown_flag = true;
         }
-        
+        ready_cv.notify_all();
+        reactor->detach(this);
+
         // Close all remaining sockets
         std::lock_guard<std::mutex> lock(pool_mutex);
         while (!available_sockets.empty()) {
             close(available_sockets.front());
             available_sockets.pop();
         }
+        for (auto& p : pending) close(p.first);
+        pending.clear();
     }
-    
-    int get_socket() {
-        std::lock_guard<std::mutex> lock(pool_mutex);
-        
-        if (available_sockets.empty()) {
-            // Create new connection if pool is empty
-            return create_connection();
-        }
-        
-        int sock = available_sockets.front();
-        available_sockets.pop();
-        return sock;
+
+    // Take a pre-connected socket. Never connects on the caller's thread: if
+    // the pool is empty, waits up to timeout_ms for the reactor to refill it
+    // and returns -1 if none arrives. On the reactor thread itself only
+    // timeout_ms = 0 makes sense.
+    int get_socket(uint32_t timeout_ms = 0) {
+        std::unique_lock<std::mutex> lock(pool_mutex);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+        while (!shutdown_flag) {
+            while (!available_sockets.empty()) {
+                int sock = available_sockets.front();
+                available_sockets.pop();
+
+                if (is_alive(sock)) {
+                    lock.unlock();
+                    reactor->wake(this);  // top up
+                    return sock;
+                }
+                close(sock);  // peer dropped it while it sat idle
+            }
+
+            lock.unlock();
+            reactor->wake(this);
+            lock.lock();
+            if (timeout_ms == 0 ||
+                (ready_cv.wait_until(lock, deadline) == std::cv_status::timeout && available_sockets.empty())) {
+                return -1;
+            }
+        }
+        return -1;
+    }
+
+    // Number of sockets to keep pre-connected
+    void set_pool_size(size_t pool_size) {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            max_pool_size = pool_size;
+        }
+        reactor->wake(this);
     }
-  
+
 private:
-    int create_connection() {
-        int sock = socket(AF_INET, SOCK_STREAM, 0);
+    static constexpr int CONNECT_TIMEOUT_MS = 1000;
+    static constexpr int BACKOFF_MIN_MS = 10;
+    static constexpr int BACKOFF_MAX_MS = 2000;
+
+    using Clock = std::chrono::steady_clock;
+
+    // Idle pooled sockets should have nothing to read; anything readable means
+    // the server closed (or reset) it
+    static bool is_alive(int sock) {
+        struct pollfd pfd = {sock, POLLIN | POLLRDHUP, 0};
+        return poll(&pfd, 1, 0) == 0;
+    }
+
+    // Non-blocking socket + connect. Returns the fd (connect in progress or
+    // done) or -1.
+    int start_connection() {
+        int sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
         if (sock < 0) {
-            std::cerr << "Socket creation failed: " << strerror(errno) << std::endl;
-            return -1;
-        }
-        
-        struct sockaddr_in serv_addr;
-        memset(&serv_addr, 0, sizeof(serv_addr));
-        serv_addr.sin_family = AF_INET;
-        serv_addr.sin_port = htons(server_port);
-        
-        if (inet_pton(AF_INET, server_ip, &serv_addr.sin_addr) <= 0) {
-            std::cerr << "Invalid address: " << server_ip << std::endl;
-            close(sock);
+            report_failure("Socket creation failed", errno);
             return -1;
         }
-        
-        // Set socket timeout
+
+        // Set socket timeout (used once the socket is handed out in blocking mode)
         struct timeval tv;
         tv.tv_sec = 1;
         tv.tv_usec = 0;
         setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
         setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        
-        if (connect(sock, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) < 0) {
-            std::cerr << "Connection failed: " << strerror(errno) << std::endl;
+
+        // Requests go out in a single send; don't let Nagle hold them back
+        int one = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0 &&
+            errno != EINPROGRESS) {
+            report_failure("Connection failed", errno);
             close(sock);
             return -1;
         }
-        
         return sock;
     }
-    
-    void maintain_pool() {
-        while (!shutdown_flag) {
-            std::unique_lock<std::mutex> lock(pool_mutex);
-            size_t current_size = available_sockets.size();
-            lock.unlock();
-            
-            if (current_size < max_pool_size) {
-                int new_sock = create_connection();
-                if (new_sock >= 0) {
-                    lock.lock();
-                    available_sockets.push(new_sock);
-                    lock.unlock();
+
+    // Connected: switch back to blocking mode and hand it to the pool
+    void add_connected(int sock) {
+        int flags = fcntl(sock, F_GETFL, 0);
+        fcntl(sock, F_SETFL, flags & ~O_NONBLOCK);
+
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        available_sockets.push(sock);
+        if (backoff_ms != 0) {
+            RF_LOG_INFO("SocketPool: Connected to %s:%u", server_ip, server_port);
+        }
+        backoff_ms = 0;
+        ready_cv.notify_one();
+    }
+
+    // Log the first failure of an outage only, then back off
+    void report_failure(const char* what, int err) {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (backoff_ms == 0) {
+            RF_LOG_ERROR("SocketPool: %s (%s:%u): %s. Retrying with backoff", what, server_ip, server_port,
+                         strerror(err));
+            backoff_ms = BACKOFF_MIN_MS;
+        } else {
+            backoff_ms = std::min(backoff_ms * 2, BACKOFF_MAX_MS);
+        }
+        retry_at = Clock::now() + std::chrono::milliseconds(backoff_ms);
+    }
+
+    // Reactor thread: start connects to cover the deficit, time out stuck
+    // ones. Returns when it next needs to run.
+    int64_t on_timer(int64_t now_ns) override {
+        Clock::time_point now = Clock::now();
+        size_t to_start = 0;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            if (shutdown_flag) return 0;
+            size_t have = available_sockets.size() + pending.size();
+            if (address_ok && now >= retry_at && have < max_pool_size) {
+                to_start = max_pool_size - have;
+            }
+        }
+
+        for (size_t i = 0; i < to_start; i++) {
+            int sock = start_connection();
+            if (sock < 0) break;
+
+            // Writable means the connect finished, one way or the other
+            reactor->watch(sock, EPOLLOUT, this);
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            pending[sock] = now + std::chrono::milliseconds(CONNECT_TIMEOUT_MS);
+        }
+
+        expire_pending();
+
+        // Next: the earliest connect deadline, or the end of the backoff
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        Clock::time_point next = Clock::time_point::max();
+        for (auto& p : pending) next = std::min(next, p.second);
+        if (backoff_ms != 0 && available_sockets.size() + pending.size() < max_pool_size) {
+            next = std::min(next, retry_at);
+        }
+        if (next == Clock::time_point::max()) return 0;
+        return now_ns + std::max<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(next - now).count(), 0);
+    }
+
+    // Reactor thread: a connect completed
+    bool on_event(int sock, uint32_t) override {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            if (!pending.erase(sock)) return false;
+        }
+        reactor->unwatch(sock);
+
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err == 0) {
+            add_connected(sock);
+        } else {
+            report_failure("Connection failed", err);
+            close(sock);
+        }
+        return true;  // replace it (or schedule the retry)
+    }
+
+    // Give up on connects that have been in progress too long (e.g. SYNs to a
+    // host that is down)
+    void expire_pending() {
+        auto now = Clock::now();
+        std::vector<int> expired;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            for (auto it = pending.begin(); it != pending.end();) {
+                if (now >= it->second) {
+                    expired.push_back(it->first);
+                    it = pending.erase(it);
+                } else {
+                    ++it;
                 }
             }
-            
-            // RF works better with no sleep
-            // std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        for (int sock : expired) {
+            reactor->unwatch(sock);
+            close(sock);
+            report_failure("Connection timed out", ETIMEDOUT);
         }
     }
-    
+
     const char* server_ip;
     uint16_t server_port;
+    struct sockaddr_in server_addr;
+    bool address_ok = false;
     size_t max_pool_size;
+
     std::queue<int> available_sockets;
+    std::unordered_map<int, Clock::time_point> pending;  // fd -> connect deadline
+    int backoff_ms = 0;
+    Clock::time_point retry_at{};
+
+    std::shared_ptr<RF::LinkReactor> reactor;
     std::mutex pool_mutex;
-    std::thread pool_thread;
+    std::condition_variable ready_cv;   // a new socket is available
     bool shutdown_flag;
-};
\ No newline at end of file
+};
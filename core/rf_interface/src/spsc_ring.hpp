@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace RF {
+
+// Bounded single-producer / single-consumer queue.
+//
+// Neither side ever blocks or takes a lock: push() on a full ring drops the
+// new element and counts it instead of waiting for the consumer. Head and
+// tail sit on separate cache lines so the two threads do not false-share.
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing needs a trivially copyable T");
+
+public:
+    // Producer only. Returns false (and counts a drop) if the ring is full.
+    bool push(const T& value) {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail_cache >= N) {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+            if (head - m_tail_cache >= N) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        m_slots[head & (N - 1)] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false if the ring is empty.
+    bool pop(T& out) {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head_cache) {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            if (tail == m_head_cache) return false;
+        }
+        out = m_slots[tail & (N - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate from any thread other than the two ends
+    size_t size() const {
+        return static_cast<size_t>(m_head.load(std::memory_order_acquire) -
+                                   m_tail.load(std::memory_order_acquire));
+    }
+
+    static constexpr size_t capacity() { return N; }
+    uint64_t pushed() const { return m_head.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<uint64_t> m_head{0};
+    uint64_t m_tail_cache = 0;  // producer's last view of m_tail
+
+    alignas(64) std::atomic<uint64_t> m_tail{0};
+    uint64_t m_head_cache = 0;  // consumer's last view of m_head
+
+    alignas(64) std::atomic<uint64_t> m_dropped{0};
+    T m_slots[N];
+};
+
+} // namespace RF
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#include "async_log.hpp"
+
+namespace RF {
+
+// Number of <item> entries in m-channelValues-0to1
+static constexpr int NUM_RCIN = 12;
+
+// Aircraft state decoded from one ExchangeData reply
+struct AircraftState {
+    double rcin[NUM_RCIN];
+    double m_airspeed_MPS;
+    double m_altitudeASL_MTR;
+    double m_altitudeAGL_MTR;
+    double m_groundspeed_MPS;
+    double m_pitchRate_DEGpSEC;
+    double m_rollRate_DEGpSEC;
+    double m_yawRate_DEGpSEC;
+    double m_azimuth_DEG;
+    double m_inclination_DEG;
+    double m_roll_DEG;
+    double m_aircraftPositionX_MTR;
+    double m_aircraftPositionY_MTR;
+    double m_velocityWorldU_MPS;
+    double m_velocityWorldV_MPS;
+    double m_velocityWorldW_MPS;
+    double m_velocityBodyU_MPS;
+    double m_velocityBodyV_MPS;
+    double m_velocityBodyW_MPS;
+    double m_accelerationWorldAX_MPS2;
+    double m_accelerationWorldAY_MPS2;
+    double m_accelerationWorldAZ_MPS2;
+    double m_accelerationBodyAX_MPS2;
+    double m_accelerationBodyAY_MPS2;
+    double m_accelerationBodyAZ_MPS2;
+    double m_windX_MPS;
+    double m_windY_MPS;
+    double m_windZ_MPS;
+    double m_propRPM;
+    double m_heliMainRotorRPM;
+    double m_batteryVoltage_VOLTS;
+    double m_batteryCurrentDraw_AMPS;
+    double m_batteryRemainingCapacity_MAH;
+    double m_fuelRemaining_OZ;
+    double m_isLocked;
+    double m_hasLostComponents;
+    double m_anEngineIsRunning;
+    double m_isTouchingGround;
+    double m_currentAircraftStatus;
+    double m_currentPhysicsTime_SEC;
+    double m_currentPhysicsSpeedMultiplier;
+    double m_orientationQuaternion_X;
+    double m_orientationQuaternion_Y;
+    double m_orientationQuaternion_Z;
+    double m_orientationQuaternion_W;
+    double m_flightAxisControllerIsActive;
+    double m_resetButtonHasBeenPressed;
+};
+
+// One ExchangeData reply tag and where its value goes in AircraftState
+struct TelemetryField {
+    const char* tag;
+    size_t offset;     // into AircraftState
+    const char* unit;  // "" when dimensionless, "bool" for true/false tags
+};
+
+// Every tag we decode besides the rcin items, in AircraftState order. Shared
+// by all instances; the reply parser hashes these names at compile time.
+static constexpr TelemetryField telemetry_schema[] = {
+    { "m-airspeed-MPS",                 offsetof(AircraftState, m_airspeed_MPS),                 "m/s" },
+    { "m-altitudeASL-MTR",              offsetof(AircraftState, m_altitudeASL_MTR),              "m" },
+    { "m-altitudeAGL-MTR",              offsetof(AircraftState, m_altitudeAGL_MTR),              "m" },
+    { "m-groundspeed-MPS",              offsetof(AircraftState, m_groundspeed_MPS),              "m/s" },
+    { "m-pitchRate-DEGpSEC",            offsetof(AircraftState, m_pitchRate_DEGpSEC),            "deg/s" },
+    { "m-rollRate-DEGpSEC",             offsetof(AircraftState, m_rollRate_DEGpSEC),             "deg/s" },
+    { "m-yawRate-DEGpSEC",              offsetof(AircraftState, m_yawRate_DEGpSEC),              "deg/s" },
+    { "m-azimuth-DEG",                  offsetof(AircraftState, m_azimuth_DEG),                  "deg" },
+    { "m-inclination-DEG",              offsetof(AircraftState, m_inclination_DEG),              "deg" },
+    { "m-roll-DEG",                     offsetof(AircraftState, m_roll_DEG),                     "deg" },
+    { "m-aircraftPositionX-MTR",        offsetof(AircraftState, m_aircraftPositionX_MTR),        "m" },
+    { "m-aircraftPositionY-MTR",        offsetof(AircraftState, m_aircraftPositionY_MTR),        "m" },
+    { "m-velocityWorldU-MPS",           offsetof(AircraftState, m_velocityWorldU_MPS),           "m/s" },
+    { "m-velocityWorldV-MPS",           offsetof(AircraftState, m_velocityWorldV_MPS),           "m/s" },
+    { "m-velocityWorldW-MPS",           offsetof(AircraftState, m_velocityWorldW_MPS),           "m/s" },
+    { "m-velocityBodyU-MPS",            offsetof(AircraftState, m_velocityBodyU_MPS),            "m/s" },
+    { "m-velocityBodyV-MPS",            offsetof(AircraftState, m_velocityBodyV_MPS),            "m/s" },
+    { "m-velocityBodyW-MPS",            offsetof(AircraftState, m_velocityBodyW_MPS),            "m/s" },
+    { "m-accelerationWorldAX-MPS2",     offsetof(AircraftState, m_accelerationWorldAX_MPS2),     "m/s^2" },
+    { "m-accelerationWorldAY-MPS2",     offsetof(AircraftState, m_accelerationWorldAY_MPS2),     "m/s^2" },
+    { "m-accelerationWorldAZ-MPS2",     offsetof(AircraftState, m_accelerationWorldAZ_MPS2),     "m/s^2" },
+    { "m-accelerationBodyAX-MPS2",      offsetof(AircraftState, m_accelerationBodyAX_MPS2),      "m/s^2" },
+    { "m-accelerationBodyAY-MPS2",      offsetof(AircraftState, m_accelerationBodyAY_MPS2),      "m/s^2" },
+    { "m-accelerationBodyAZ-MPS2",      offsetof(AircraftState, m_accelerationBodyAZ_MPS2),      "m/s^2" },
+    { "m-windX-MPS",                    offsetof(AircraftState, m_windX_MPS),                    "m/s" },
+    { "m-windY-MPS",                    offsetof(AircraftState, m_windY_MPS),                    "m/s" },
+    { "m-windZ-MPS",                    offsetof(AircraftState, m_windZ_MPS),                    "m/s" },
+    { "m-propRPM",                      offsetof(AircraftState, m_propRPM),                      "rpm" },
+    { "m-heliMainRotorRPM",             offsetof(AircraftState, m_heliMainRotorRPM),             "rpm" },
+    { "m-batteryVoltage-VOLTS",         offsetof(AircraftState, m_batteryVoltage_VOLTS),         "V" },
+    { "m-batteryCurrentDraw-AMPS",      offsetof(AircraftState, m_batteryCurrentDraw_AMPS),      "A" },
+    { "m-batteryRemainingCapacity-MAH", offsetof(AircraftState, m_batteryRemainingCapacity_MAH), "mAh" },
+    { "m-fuelRemaining-OZ",             offsetof(AircraftState, m_fuelRemaining_OZ),             "oz" },
+    { "m-isLocked",                     offsetof(AircraftState, m_isLocked),                     "bool" },
+    { "m-hasLostComponents",            offsetof(AircraftState, m_hasLostComponents),            "bool" },
+    { "m-anEngineIsRunning",            offsetof(AircraftState, m_anEngineIsRunning),            "bool" },
+    { "m-isTouchingGround",             offsetof(AircraftState, m_isTouchingGround),             "bool" },
+    { "m-currentAircraftStatus",        offsetof(AircraftState, m_currentAircraftStatus),        "" },
+    { "m-currentPhysicsTime-SEC",       offsetof(AircraftState, m_currentPhysicsTime_SEC),       "s" },
+    { "m-currentPhysicsSpeedMultiplier", offsetof(AircraftState, m_currentPhysicsSpeedMultiplier), "" },
+    { "m-orientationQuaternion-X",      offsetof(AircraftState, m_orientationQuaternion_X),      "" },
+    { "m-orientationQuaternion-Y",      offsetof(AircraftState, m_orientationQuaternion_Y),      "" },
+    { "m-orientationQuaternion-Z",      offsetof(AircraftState, m_orientationQuaternion_Z),      "" },
+    { "m-orientationQuaternion-W",      offsetof(AircraftState, m_orientationQuaternion_W),      "" },
+    { "m-flightAxisControllerIsActive", offsetof(AircraftState, m_flightAxisControllerIsActive), "bool" },
+    { "m-resetButtonHasBeenPressed",    offsetof(AircraftState, m_resetButtonHasBeenPressed),    "bool" },
+};
+
+static constexpr int NUM_TELEMETRY_TAGS = sizeof(telemetry_schema) / sizeof(telemetry_schema[0]);
+
+// Which parts of the reply to decode: bit i = telemetry_schema[i], plus
+// TELEMETRY_RCIN for the <item> channel values
+using TelemetryMask = uint64_t;
+
+static_assert(NUM_TELEMETRY_TAGS < 63, "TelemetryMask has one bit per tag plus TELEMETRY_RCIN");
+static constexpr TelemetryMask TELEMETRY_RCIN = uint64_t(1) << 63;
+static constexpr TelemetryMask TELEMETRY_TAGS_ALL = (uint64_t(1) << NUM_TELEMETRY_TAGS) - 1;
+static constexpr TelemetryMask TELEMETRY_ALL = TELEMETRY_TAGS_ALL | TELEMETRY_RCIN;
+
+namespace detail {
+
+constexpr bool tag_equal(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+// Not constexpr on purpose: reaching it while building a constexpr mask
+// fails the compile, at run time it just reports the tag
+inline TelemetryMask unknown_telemetry_tag(const char* tag) {
+    RF_LOG_ERROR("Unknown telemetry tag: %s", tag);
+    return 0;
+}
+
+// Every schema entry is a distinct, in-bounds double of AircraftState
+constexpr bool schema_is_consistent() {
+    for (int i = 0; i < NUM_TELEMETRY_TAGS; i++) {
+        const TelemetryField& f = telemetry_schema[i];
+        if (f.offset % sizeof(double) != 0 || f.offset < sizeof(AircraftState::rcin) ||
+            f.offset + sizeof(double) > sizeof(AircraftState)) {
+            return false;
+        }
+        for (int j = 0; j < i; j++) {
+            if (telemetry_schema[j].offset == f.offset || tag_equal(telemetry_schema[j].tag, f.tag)) return false;
+        }
+    }
+    return sizeof(AircraftState) == sizeof(double) * (NUM_RCIN + NUM_TELEMETRY_TAGS);
+}
+
+static_assert(schema_is_consistent(), "telemetry_schema out of sync with AircraftState");
+
+} // namespace detail
+
+// Index of `tag` in telemetry_schema, -1 if unknown
+constexpr int telemetry_field(const char* tag) {
+    for (int i = 0; i < NUM_TELEMETRY_TAGS; i++) {
+        if (detail::tag_equal(telemetry_schema[i].tag, tag)) return i;
+    }
+    return -1;
+}
+
+// Mask of the given tags, e.g.
+//   constexpr TelemetryMask fields = telemetry_fields({"m-roll-DEG", "m-azimuth-DEG"});
+// A misspelled tag is a compile error when the result is constexpr.
+constexpr TelemetryMask telemetry_fields(std::initializer_list<const char*> tags) {
+    TelemetryMask mask = 0;
+    for (const char* tag : tags) {
+        int field = telemetry_field(tag);
+        mask |= field < 0 ? detail::unknown_telemetry_tag(tag) : uint64_t(1) << field;
+    }
+    return mask;
+}
+
+// Common subsets
+static constexpr TelemetryMask TELEMETRY_ATTITUDE = telemetry_fields({
+    "m-roll-DEG", "m-inclination-DEG", "m-azimuth-DEG",
+    "m-rollRate-DEGpSEC", "m-pitchRate-DEGpSEC", "m-yawRate-DEGpSEC",
+    "m-orientationQuaternion-X", "m-orientationQuaternion-Y",
+    "m-orientationQuaternion-Z", "m-orientationQuaternion-W",
+});
+
+static constexpr TelemetryMask TELEMETRY_POSITION = telemetry_fields({
+    "m-aircraftPositionX-MTR", "m-aircraftPositionY-MTR",
+    "m-altitudeASL-MTR", "m-altitudeAGL-MTR",
+    "m-velocityWorldU-MPS", "m-velocityWorldV-MPS", "m-velocityWorldW-MPS",
+});
+
+static constexpr TelemetryMask TELEMETRY_PHYSICS_TIME = telemetry_fields({"m-currentPhysicsTime-SEC"});
+
+// What RFInterface needs to order replies and follow the sim clock
+static constexpr TelemetryMask TELEMETRY_CLOCK =
+    TELEMETRY_PHYSICS_TIME | telemetry_fields({"m-currentPhysicsSpeedMultiplier"});
+
+inline double& telemetry_value(AircraftState& state, int field) {
+    return *reinterpret_cast<double*>(reinterpret_cast<char*>(&state) + telemetry_schema[field].offset);
+}
+
+inline double telemetry_value(const AircraftState& state, int field) {
+    return *reinterpret_cast<const double*>(reinterpret_cast<const char*>(&state) + telemetry_schema[field].offset);
+}
+
+} // namespace RF
@@ -0,0 +1,369 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <csignal>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <linux/io_uring.h>
+
+#include <atomic>
+#include <chrono>
+
+#include "async_log.hpp"
+#include "http_response.hpp"
+
+namespace RF {
+
+// One RealFlight request/reply cycle as a single io_uring submission.
+//
+// RealFlight wants a fresh TCP connection per request, so the socket path
+// costs socket + connect (pool) + send + select + recv... + close per
+// exchange. Here the whole chain goes in as linked SQEs and the caller
+// blocks in one io_uring_enter():
+//
+//   CLOSE (previous socket) | SOCKET -> CONNECT -> SEND -> READ_FIXED
+//
+// Sockets are direct descriptors (two registered file slots, used in turn,
+// so closing the last one can ride along with the next chain unordered).
+// The reply is read into a buffer registered once. Replies longer than one
+// segment take one more enter per extra READ_FIXED.
+//
+// Raw syscalls against <linux/io_uring.h>, no liburing. open() returns false
+// when the kernel lacks io_uring or any of the opcodes used, so the caller
+// can stay on its socket path. Not thread safe: one exchange at a time.
+class UringTransport {
+public:
+    UringTransport() = default;
+    ~UringTransport() { close(); }
+
+    UringTransport(const UringTransport&) = delete;
+    UringTransport& operator=(const UringTransport&) = delete;
+
+    bool open(const struct sockaddr_in& server, char* reply_buffer, size_t reply_capacity) {
+        close();
+        m_server = server;
+        m_buffer = reply_buffer;
+        m_capacity = reply_capacity;
+
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_COOP_TASKRUN;  // no IPIs; we always wait in enter
+        m_ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, RING_ENTRIES, &params));
+        if (m_ring_fd < 0 && errno == EINVAL) {
+            memset(&params, 0, sizeof(params));
+            m_ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, RING_ENTRIES, &params));
+        }
+        if (m_ring_fd < 0) {
+            return fail("io_uring_setup", errno);
+        }
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+            return fail("kernel too old (needs single mmap and EXT_ARG)", 0);
+        }
+
+        // SQ and CQ rings share one mapping; SQEs are separate
+        m_ring_size = std::max(params.sq_off.array + params.sq_entries * sizeof(uint32_t),
+                               params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+        m_ring = mmap(nullptr, m_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      m_ring_fd, IORING_OFF_SQ_RING);
+        m_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+        void* sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          m_ring_fd, IORING_OFF_SQES);
+        if (m_ring == MAP_FAILED || sqes == MAP_FAILED) {
+            if (m_ring == MAP_FAILED) m_ring = nullptr;
+            if (sqes != MAP_FAILED) munmap(sqes, m_sqes_size);
+            return fail("mmap", errno);
+        }
+        m_sqes = static_cast<struct io_uring_sqe*>(sqes);
+
+        char* ring = static_cast<char*>(m_ring);
+        m_sq_head = reinterpret_cast<uint32_t*>(ring + params.sq_off.head);
+        m_sq_tail = reinterpret_cast<uint32_t*>(ring + params.sq_off.tail);
+        m_sq_mask = *reinterpret_cast<uint32_t*>(ring + params.sq_off.ring_mask);
+        m_sq_array = reinterpret_cast<uint32_t*>(ring + params.sq_off.array);
+        m_cq_head = reinterpret_cast<uint32_t*>(ring + params.cq_off.head);
+        m_cq_tail = reinterpret_cast<uint32_t*>(ring + params.cq_off.tail);
+        m_cq_mask = *reinterpret_cast<uint32_t*>(ring + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<struct io_uring_cqe*>(ring + params.cq_off.cqes);
+
+        if (!supports_opcodes()) {
+            return fail("missing opcodes (needs SOCKET, CONNECT, SEND, READ_FIXED, CLOSE)", 0);
+        }
+
+        struct iovec iov = {m_buffer, m_capacity};
+        if (syscall(__NR_io_uring_register, m_ring_fd, IORING_REGISTER_BUFFERS, &iov, 1) < 0) {
+            return fail("register buffer", errno);
+        }
+        int32_t files[NUM_SLOTS] = {-1, -1};  // sparse: SOCKET fills them
+        if (syscall(__NR_io_uring_register, m_ring_fd, IORING_REGISTER_FILES, files, NUM_SLOTS) < 0) {
+            return fail("register files", errno);
+        }
+        return true;
+    }
+
+    void close() {
+        if (m_ring) munmap(m_ring, m_ring_size);
+        if (m_sqes) munmap(m_sqes, m_sqes_size);
+        if (m_ring_fd >= 0) ::close(m_ring_fd);  // drops the registered sockets too
+        m_ring = nullptr;
+        m_sqes = nullptr;
+        m_ring_fd = -1;
+        m_open_slot = -1;
+        m_pending = 0;
+    }
+
+    bool is_open() const { return m_ring_fd >= 0; }
+
+    // Send `request` on a new connection and read the reply into the
+    // registered buffer until `framing` has all of it (exactly
+    // Content-Length bytes of body, or up to the server closing), or
+    // timeout_ms passes. Returns the reply length (NUL-terminated in the
+    // buffer) or -1, also for a reply that does not fit the buffer.
+    // first_byte gets the time the first reply bytes landed.
+    ssize_t exchange(const char* request, size_t len, HttpResponseParser& framing, uint32_t timeout_ms,
+                     std::chrono::steady_clock::time_point* first_byte = nullptr) {
+        if (!is_open()) return -1;
+        framing.reset();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+        int slot = m_next_slot;
+        m_next_slot = (m_next_slot + 1) % NUM_SLOTS;
+
+        unsigned queued = 0;
+        if (m_open_slot >= 0) {
+            struct io_uring_sqe* close_sqe = next_sqe(IORING_OP_CLOSE, TAG_CLOSE);
+            close_sqe->file_index = m_open_slot + 1;
+            queued++;
+            m_open_slot = -1;
+        }
+
+        struct io_uring_sqe* sqe = next_sqe(IORING_OP_SOCKET, TAG_SOCKET);
+        sqe->fd = AF_INET;
+        sqe->off = SOCK_STREAM;
+        sqe->file_index = slot + 1;
+        sqe->flags = IOSQE_IO_LINK;
+
+        sqe = next_sqe(IORING_OP_CONNECT, TAG_CONNECT);
+        sqe->fd = slot;
+        sqe->addr = reinterpret_cast<uint64_t>(&m_server);
+        sqe->off = sizeof(m_server);
+        sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+
+        sqe = next_sqe(IORING_OP_SEND, TAG_SEND);
+        sqe->fd = slot;
+        sqe->addr = reinterpret_cast<uint64_t>(request);
+        sqe->len = static_cast<uint32_t>(len);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+
+        queue_read(slot, 0, m_capacity - 1);
+        queued += 4;
+
+        size_t received = 0;
+        int error = 0;
+        bool done = false;
+        bool too_big = false;
+        while (!done) {
+            if (!submit_and_wait(queued, deadline)) {
+                RF_LOG_ERROR("UringTransport: timeout waiting for response");
+                cancel_all();
+                m_open_slot = slot;
+                return -1;
+            }
+            queued = 0;
+
+            // Every CQE of this round is in: a failed link cancels the rest
+            int32_t read_res = INT32_MIN;
+            while (*m_cq_head != __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+                const struct io_uring_cqe& cqe = m_cqes[*m_cq_head & m_cq_mask];
+                if (cqe.user_data == TAG_READ) {
+                    read_res = cqe.res;
+                } else if (cqe.user_data != TAG_CLOSE && cqe.res < 0 && error == 0) {
+                    error = -cqe.res;  // first failure in the chain
+                }
+                __atomic_store_n(m_cq_head, *m_cq_head + 1, __ATOMIC_RELEASE);
+                m_pending--;
+            }
+            if (read_res == INT32_MIN) continue;  // read still outstanding
+
+            if (read_res > 0) {
+                if (received == 0 && first_byte) *first_byte = std::chrono::steady_clock::now();
+                received += read_res;
+                m_buffer[received] = '\0';
+                framing.feed(m_buffer, received);
+                size_t expected = framing.expected_size();
+                done = framing.complete() || framing.failed();
+                if (!done && (expected >= m_capacity || received >= m_capacity - 1)) {
+                    RF_LOG_ERROR("UringTransport: reply larger than the %zu byte buffer", m_capacity);
+                    framing.fail();
+                    too_big = true;
+                    done = true;
+                }
+                if (!done) {
+                    queue_read(slot, received, expected ? expected - received : m_capacity - 1 - received);
+                    queued = 1;
+                }
+            } else {
+                if (read_res < 0 && error == 0 && read_res != -ECANCELED) error = -read_res;
+                if (read_res == 0) {
+                    framing.finish(received);
+                } else {
+                    framing.fail();
+                }
+                done = true;
+            }
+        }
+
+        m_open_slot = slot;  // closed with the next chain
+        if (!framing.complete()) {
+            if (error != 0) {
+                RF_LOG_ERROR("UringTransport: exchange failed: %s", strerror(error));
+            } else if (received > 0 && !too_big) {
+                RF_LOG_ERROR("UringTransport: incomplete reply (%zu bytes)", received);
+            }
+            return -1;
+        }
+        return static_cast<ssize_t>(received);
+    }
+
+    // io_uring_enter() calls made so far (each exchange is usually one)
+    uint64_t enters() const { return m_enters.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr unsigned RING_ENTRIES = 8;
+    static constexpr int NUM_SLOTS = 2;
+
+    enum : uint64_t { TAG_CLOSE = 1, TAG_SOCKET, TAG_CONNECT, TAG_SEND, TAG_READ, TAG_CANCEL };
+
+    bool fail(const char* what, int err) {
+        RF_LOG_INFO("UringTransport: unavailable, %s%s%s", what, err ? ": " : "", err ? strerror(err) : "");
+        close();
+        return false;
+    }
+
+    bool supports_opcodes() {
+        static constexpr int OPS = 256;
+        static char storage[sizeof(struct io_uring_probe) + OPS * sizeof(struct io_uring_probe_op)];
+        memset(storage, 0, sizeof(storage));
+        struct io_uring_probe* probe = reinterpret_cast<struct io_uring_probe*>(storage);
+        if (syscall(__NR_io_uring_register, m_ring_fd, IORING_REGISTER_PROBE, probe, OPS) < 0) return false;
+
+        const int needed[] = {IORING_OP_SOCKET, IORING_OP_CONNECT, IORING_OP_SEND, IORING_OP_READ_FIXED,
+                              IORING_OP_CLOSE, IORING_OP_ASYNC_CANCEL};
+        for (int op : needed) {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+        }
+        return true;
+    }
+
+    struct io_uring_sqe* next_sqe(uint8_t opcode, uint64_t tag) {
+        uint32_t tail = *m_sq_tail;
+        uint32_t index = tail & m_sq_mask;
+        struct io_uring_sqe* sqe = &m_sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->user_data = tag;
+        m_sq_array[index] = index;
+        __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+        m_pending++;
+        return sqe;
+    }
+
+    // Up to `len` bytes into the registered buffer at `offset`; the last
+    // link of a chain
+    void queue_read(int slot, size_t offset, size_t len) {
+        struct io_uring_sqe* sqe = next_sqe(IORING_OP_READ_FIXED, TAG_READ);
+        sqe->fd = slot;
+        sqe->addr = reinterpret_cast<uint64_t>(m_buffer + offset);
+        sqe->len = static_cast<uint32_t>(len);
+        sqe->buf_index = 0;
+        sqe->flags = IOSQE_FIXED_FILE;
+    }
+
+    // Submit what is queued and wait for every outstanding completion, or
+    // the deadline. False on timeout.
+    bool submit_and_wait(unsigned to_submit, std::chrono::steady_clock::time_point deadline) {
+        while (true) {
+            auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0) return false;
+
+            struct __kernel_timespec ts = {left / 1000000000LL, left % 1000000000LL};
+            struct io_uring_getevents_arg arg;
+            memset(&arg, 0, sizeof(arg));
+            arg.sigmask_sz = _NSIG / 8;
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+
+            unsigned ready = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE) - *m_cq_head;
+            unsigned wait = m_pending > ready ? m_pending - ready : 0;
+            m_enters.fetch_add(1, std::memory_order_relaxed);
+            int ret = static_cast<int>(syscall(__NR_io_uring_enter, m_ring_fd, to_submit, wait,
+                                               IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                                               &arg, sizeof(arg)));
+            if (ret >= 0) {
+                to_submit -= std::min<unsigned>(to_submit, static_cast<unsigned>(ret));
+                if (to_submit == 0 && __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE) - *m_cq_head >= m_pending) {
+                    return true;
+                }
+                continue;
+            }
+            if (errno == ETIME) return false;
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                RF_LOG_ERROR("UringTransport: io_uring_enter: %s", strerror(errno));
+                return false;
+            }
+        }
+    }
+
+    // After a timeout: cancel everything in flight and drain the CQEs
+    void cancel_all() {
+        struct io_uring_sqe* sqe = next_sqe(IORING_OP_ASYNC_CANCEL, TAG_CANCEL);
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+        unsigned to_submit = 1;
+        while (m_pending > 0) {
+            unsigned ready = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE) - *m_cq_head;
+            m_enters.fetch_add(1, std::memory_order_relaxed);
+            int ret = static_cast<int>(syscall(__NR_io_uring_enter, m_ring_fd, to_submit,
+                                               m_pending > ready ? m_pending - ready : 0,
+                                               IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (ret < 0 && errno != EINTR) break;
+            if (ret > 0) to_submit = 0;
+            while (*m_cq_head != __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+                __atomic_store_n(m_cq_head, *m_cq_head + 1, __ATOMIC_RELEASE);
+                m_pending--;
+            }
+        }
+    }
+
+    struct sockaddr_in m_server;
+    char* m_buffer = nullptr;
+    size_t m_capacity = 0;
+
+    int m_ring_fd = -1;
+    void* m_ring = nullptr;
+    size_t m_ring_size = 0;
+    struct io_uring_sqe* m_sqes = nullptr;
+    size_t m_sqes_size = 0;
+
+    uint32_t* m_sq_head = nullptr;
+    uint32_t* m_sq_tail = nullptr;
+    uint32_t m_sq_mask = 0;
+    uint32_t* m_sq_array = nullptr;
+    uint32_t* m_cq_head = nullptr;
+    uint32_t* m_cq_tail = nullptr;
+    uint32_t m_cq_mask = 0;
+    struct io_uring_cqe* m_cqes = nullptr;
+
+    unsigned m_pending = 0;  // submitted or queued, CQE not reaped yet
+    int m_next_slot = 0;
+    int m_open_slot = -1;    // socket of the last exchange, still open
+    std::atomic<uint64_t> m_enters{0};
+};
+
+} // namespace RF
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "async_log.hpp"
+
+namespace RF {
+
+// Raw SOAP traffic of a session, for replay without RealFlight.
+//
+// File layout: an 8-byte magic, then one entry per request or response:
+//   [CaptureEntryHeader][length bytes exactly as sent / received]
+// A response carries the id of the request it answers, so captures of the
+// pipelined loop pair up even though replies complete out of order.
+static constexpr char WIRE_CAPTURE_MAGIC[8] = {'R', 'F', 'C', 'A', 'P', 0, 0, 1};
+
+enum CaptureKind : uint32_t {
+    CAPTURE_REQUEST = 1,
+    CAPTURE_RESPONSE = 2,
+};
+
+struct CaptureEntryHeader {
+    uint32_t kind;          // CaptureKind
+    uint32_t length;        // bytes following this header
+    uint64_t id;            // request number, 1-based
+    int64_t host_time_ns;   // steady_clock when sent / fully received
+};
+
+struct CaptureEntry {
+    CaptureKind kind;
+    uint64_t id;
+    int64_t host_time_ns;
+    std::string bytes;
+};
+
+// Appends entries through a large stdio buffer, so most captures are a
+// memcpy and the write() happens once per ~1 MB. Not thread safe.
+class WireCapture {
+public:
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    WireCapture() = default;
+    ~WireCapture() { close(); }
+
+    WireCapture(const WireCapture&) = delete;
+    WireCapture& operator=(const WireCapture&) = delete;
+
+    bool open(const char* path) {
+        close();
+        m_file = fopen(path, "wb");
+        if (!m_file) {
+            RF_LOG_ERROR("WireCapture: cannot open %s: %s", path, strerror(errno));
+            return false;
+        }
+        m_buffer.resize(BUFFER_SIZE);
+        setvbuf(m_file, m_buffer.data(), _IOFBF, m_buffer.size());
+        fwrite(WIRE_CAPTURE_MAGIC, 1, sizeof(WIRE_CAPTURE_MAGIC), m_file);
+        m_next_id = 0;
+        return true;
+    }
+
+    void close() {
+        if (m_file) fclose(m_file);
+        m_file = nullptr;
+    }
+
+    bool is_open() const { return m_file != nullptr; }
+
+    // Returns the id to pass to response() for the reply, 0 when not capturing
+    uint64_t request(const char* data, size_t len) {
+        if (!m_file) return 0;
+        write(CAPTURE_REQUEST, ++m_next_id, data, len);
+        return m_next_id;
+    }
+
+    void response(uint64_t id, const char* data, size_t len) {
+        if (!m_file || id == 0) return;
+        write(CAPTURE_RESPONSE, id, data, len);
+    }
+
+private:
+    void write(CaptureKind kind, uint64_t id, const char* data, size_t len) {
+        CaptureEntryHeader header;
+        header.kind = kind;
+        header.length = static_cast<uint32_t>(len);
+        header.id = id;
+        header.host_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        fwrite(&header, sizeof(header), 1, m_file);
+        fwrite(data, 1, len, m_file);
+    }
+
+    FILE* m_file = nullptr;
+    std::vector<char> m_buffer;
+    uint64_t m_next_id = 0;
+};
+
+// Whole capture in memory, in file order. A truncated last entry (capture
+// cut short by a crash) is dropped.
+inline bool read_wire_capture(const char* path, std::vector<CaptureEntry>& entries) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        RF_LOG_ERROR("cannot open %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    char magic[sizeof(WIRE_CAPTURE_MAGIC)];
+    if (fread(magic, 1, sizeof(magic), f) != sizeof(magic) ||
+        memcmp(magic, WIRE_CAPTURE_MAGIC, sizeof(magic)) != 0) {
+        RF_LOG_ERROR("%s is not a wire capture", path);
+        fclose(f);
+        return false;
+    }
+
+    entries.clear();
+    CaptureEntryHeader header;
+    while (fread(&header, sizeof(header), 1, f) == 1) {
+        if (header.kind != CAPTURE_REQUEST && header.kind != CAPTURE_RESPONSE) break;
+
+        CaptureEntry entry;
+        entry.kind = static_cast<CaptureKind>(header.kind);
+        entry.id = header.id;
+        entry.host_time_ns = header.host_time_ns;
+        entry.bytes.resize(header.length);
+        if (fread(&entry.bytes[0], 1, header.length, f) != header.length) break;
+        entries.push_back(std::move(entry));
+    }
+    fclose(f);
+    return true;
+}
+
+} // namespace RF
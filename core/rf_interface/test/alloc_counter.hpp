@@ -0,0 +1,72 @@
+#pragma once
+
+// Heap allocation counter for the benchmarks: replaces the global operator
+// new/delete with malloc/free and counts every allocation made by the
+// calling thread in t_allocations, so background threads (socket pool,
+// joystick) do not pollute the numbers for the thread under test.
+//
+// Defines the replacement operators: include from exactly one translation
+// unit of an executable.
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+static thread_local uint64_t t_allocations = 0;
+
+// Every replaceable form, aligned ones included, so no new/delete pair
+// mixes ours with the default. Out of line: GCC inlines visible operators
+// into their callers and then takes the malloc()/free() inside for
+// mismatched pairs.
+__attribute__((noinline)) void* operator new(size_t size) {
+    t_allocations++;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void* operator new[](size_t size) { return operator new(size); }
+
+__attribute__((noinline)) void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    t_allocations++;
+    return malloc(size ? size : 1);
+}
+
+__attribute__((noinline)) void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+// Over-aligned types (alignas beyond __STDCPP_DEFAULT_NEW_ALIGNMENT__).
+// aligned_alloc() wants the size rounded up to a multiple of the alignment.
+static void* aligned_malloc(size_t size, std::align_val_t al) {
+    size_t align = static_cast<size_t>(al);
+    size_t rounded = size ? (size + align - 1) / align * align : align;
+    return aligned_alloc(align, rounded);
+}
+
+__attribute__((noinline)) void* operator new(size_t size, std::align_val_t al) {
+    t_allocations++;
+    if (void* p = aligned_malloc(size, al)) return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void* operator new[](size_t size, std::align_val_t al) { return operator new(size, al); }
+
+__attribute__((noinline)) void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    t_allocations++;
+    return aligned_malloc(size, al);
+}
+
+__attribute__((noinline)) void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t& tag) noexcept {
+    return operator new(size, al, tag);
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete[](void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+__attribute__((noinline)) void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::align_val_t) noexcept { free(p); }
+__attribute__((noinline)) void operator delete[](void* p, std::align_val_t) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t, std::align_val_t) noexcept { free(p); }
+__attribute__((noinline)) void operator delete[](void* p, size_t, std::align_val_t) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { free(p); }
+__attribute__((noinline)) void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { free(p); }
@@ -0,0 +1,371 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "telemetry_schema.hpp"
+
+namespace RF {
+
+// A small electric trainer (about a 1.6 m foam high-wing), linear
+// aerodynamics with a smooth stall. Units SI, angles in radians.
+struct FlightModelParams {
+    double mass = 1.8;              // kg
+    double wing_area = 0.30;        // m^2
+    double span = 1.6;              // m
+    double chord = 0.19;            // m
+    double ixx = 0.10, iyy = 0.15, izz = 0.22;  // kg m^2
+
+    double max_deflection = 0.35;   // control surfaces at full stick
+    double max_thrust = 20.0;       // N, static
+    double prop_speed = 30.0;       // m/s at which thrust falls to 0
+    double max_rpm = 9000.0;
+
+    // Lift and drag
+    double cl0 = 0.30, cl_alpha = 4.8, cl_elevator = 0.3, cl_flaps = 0.4;
+    double stall_alpha = 0.26;
+    double cd0 = 0.030, cd_induced = 0.06, cd_flaps = 0.03, cd_gear = 0.01;
+    double cy_beta = -0.4, cy_rudder = 0.15;
+
+    // Moments: roll, pitch, yaw
+    double cl_beta = -0.06, cl_p = -0.50, cl_r = 0.10, cl_aileron = 0.20;
+    double cm0 = 0.0, cm_alpha = -0.8, cm_q = -12.0, cm_elevator = 0.8, cm_flaps = -0.05;
+    double cn_beta = 0.08, cn_p = -0.03, cn_r = -0.15, cn_rudder = 0.06, cn_aileron = -0.01;
+
+    // Ground
+    double ground_asl = 0.0;        // m, flat field
+    double rolling_friction = 0.05; // g per g of weight on the wheels
+    double steer_rate = 0.2;        // rad/s of nosewheel yaw per m/s, full rudder
+    double crash_speed = 4.0;       // m/s vertical at touchdown
+
+    // Battery: 3S 2200 mAh
+    double cells = 3;
+    double capacity_mah = 2200.0;
+    double max_current = 30.0;      // A at full throttle
+    double internal_resistance = 0.05;
+
+    // Start of every run and every ResetAircraft: on the runway at rest
+    // (altitude 0), or in the air at this height and airspeed, heading north
+    double start_altitude = 0.0;    // m AGL
+    double start_airspeed = 0.0;    // m/s
+
+    double wind_north = 0.0, wind_east = 0.0, wind_down = 0.0;  // m/s
+};
+
+// Rigid-body 6-DOF fixed-wing model with the RealFlight controls and
+// telemetry, for running RFInterface and the loops above it without the
+// simulator. Quaternion attitude, fixed step, semi-implicit Euler; no heap.
+//
+// Controls are the ExchangeData channels: 0 aileron (> 0.5 rolls right),
+// 1 elevator (> 0.5 pitches up), 2 throttle, 3 rudder (> 0.5 yaws right),
+// 4 flaps, 5 gear (drag only).
+//
+// Internally the world is NED and the body frame forward-right-down. The
+// telemetry uses the axes ArduPilot's FlightAxis backend reads from
+// RealFlight: position X east / Y north, world velocity and acceleration
+// north-east-down (U, V, W), body velocity and acceleration
+// forward-right-down, yaw rate positive to the left, and the orientation
+// quaternion as (X, Y, Z, W) = (y, x, -z, w) of the NED one.
+class FlightModel {
+public:
+    explicit FlightModel(const FlightModelParams& params = FlightModelParams()) : m_p(params) {
+        reset();
+    }
+
+    const FlightModelParams& params() const { return m_p; }
+
+    void reset() {
+        m_time = 0.0;
+        memset(m_pos, 0, sizeof(m_pos));
+        memset(m_vel, 0, sizeof(m_vel));
+        memset(m_accel, 0, sizeof(m_accel));
+        memset(m_rate, 0, sizeof(m_rate));
+        m_q[0] = 1.0;
+        m_q[1] = m_q[2] = m_q[3] = 0.0;
+        m_pos[2] = -(m_p.ground_asl + m_p.start_altitude);
+        m_vel[0] = m_p.start_airspeed;
+        m_force[0] = m_force[1] = 0.0;
+        m_force[2] = -GRAVITY;
+        m_rpm = 0.0;
+        m_current = 0.0;
+        m_used_mah = 0.0;
+        m_airspeed = m_p.start_airspeed;
+        m_on_ground = m_p.start_altitude <= 0.0;
+        m_crashed = false;
+        for (int i = 0; i < NUM_RCIN; i++) m_channels[i] = 0.5;
+        m_channels[2] = 0.0;  // throttle
+        m_channels[4] = 0.0;  // flaps
+        m_channels[5] = 0.0;  // gear
+    }
+
+    void set_controls(const double channels[NUM_RCIN]) {
+        for (int i = 0; i < NUM_RCIN; i++) m_channels[i] = std::min(1.0, std::max(0.0, channels[i]));
+    }
+
+    // Advance by dt seconds, in sub-steps of at most MAX_SUBSTEP
+    void step(double dt) {
+        int n = std::max(1, static_cast<int>(std::ceil(dt / MAX_SUBSTEP - 1e-9)));
+        for (int i = 0; i < n; i++) integrate(dt / n);
+        m_time += dt;
+    }
+
+    double time() const { return m_time; }
+    bool crashed() const { return m_crashed; }
+
+    // Everything an ExchangeData reply carries, except the physics time and
+    // speed multiplier, which belong to whoever steps the model
+    void telemetry(AircraftState& s) const {
+        memset(&s, 0, sizeof(s));
+        for (int i = 0; i < NUM_RCIN; i++) s.rcin[i] = m_channels[i];
+
+        double r[3][3];
+        rotation(r);
+        double vb[3], ab[3];
+        to_body(r, m_vel, vb);
+        to_body(r, m_force, ab);
+        double roll, pitch, yaw;
+        euler(roll, pitch, yaw);
+
+        double altitude = -m_pos[2];
+        s.m_airspeed_MPS = m_airspeed;
+        s.m_altitudeASL_MTR = altitude;
+        s.m_altitudeAGL_MTR = altitude - m_p.ground_asl;
+        s.m_groundspeed_MPS = std::hypot(m_vel[0], m_vel[1]);
+        s.m_rollRate_DEGpSEC = deg(m_rate[0]);
+        s.m_pitchRate_DEGpSEC = deg(m_rate[1]);
+        s.m_yawRate_DEGpSEC = -deg(m_rate[2]);
+        s.m_azimuth_DEG = deg(yaw);
+        s.m_inclination_DEG = deg(pitch);
+        s.m_roll_DEG = deg(roll);
+        s.m_aircraftPositionX_MTR = m_pos[1];
+        s.m_aircraftPositionY_MTR = m_pos[0];
+        s.m_velocityWorldU_MPS = m_vel[0];
+        s.m_velocityWorldV_MPS = m_vel[1];
+        s.m_velocityWorldW_MPS = m_vel[2];
+        s.m_velocityBodyU_MPS = vb[0];
+        s.m_velocityBodyV_MPS = vb[1];
+        s.m_velocityBodyW_MPS = vb[2];
+        s.m_accelerationWorldAX_MPS2 = m_accel[0];
+        s.m_accelerationWorldAY_MPS2 = m_accel[1];
+        s.m_accelerationWorldAZ_MPS2 = m_accel[2];
+        s.m_accelerationBodyAX_MPS2 = ab[0];
+        s.m_accelerationBodyAY_MPS2 = ab[1];
+        s.m_accelerationBodyAZ_MPS2 = ab[2];
+        s.m_windX_MPS = m_p.wind_east;
+        s.m_windY_MPS = m_p.wind_north;
+        s.m_windZ_MPS = m_p.wind_down;
+        s.m_propRPM = m_rpm;
+        s.m_batteryCurrentDraw_AMPS = m_current;
+        s.m_batteryRemainingCapacity_MAH = std::max(0.0, m_p.capacity_mah - m_used_mah);
+        double charge = s.m_batteryRemainingCapacity_MAH / m_p.capacity_mah;
+        s.m_batteryVoltage_VOLTS = m_p.cells * (3.5 + 0.7 * charge) - m_current * m_p.internal_resistance;
+        s.m_hasLostComponents = m_crashed;
+        s.m_anEngineIsRunning = m_rpm > 1.0;
+        s.m_isTouchingGround = m_on_ground;
+        s.m_orientationQuaternion_X = m_q[2];
+        s.m_orientationQuaternion_Y = m_q[1];
+        s.m_orientationQuaternion_Z = -m_q[3];
+        s.m_orientationQuaternion_W = m_q[0];
+        s.m_flightAxisControllerIsActive = 1.0;
+    }
+
+private:
+    static constexpr double GRAVITY = 9.80665;
+    static constexpr double AIR_DENSITY = 1.225;
+    static constexpr double MAX_SUBSTEP = 0.00125;  // s
+
+    static double deg(double rad) { return rad * (180.0 / M_PI); }
+
+    // Body -> NED
+    void rotation(double r[3][3]) const {
+        double w = m_q[0], x = m_q[1], y = m_q[2], z = m_q[3];
+        r[0][0] = 1 - 2 * (y * y + z * z); r[0][1] = 2 * (x * y - w * z);     r[0][2] = 2 * (x * z + w * y);
+        r[1][0] = 2 * (x * y + w * z);     r[1][1] = 1 - 2 * (x * x + z * z); r[1][2] = 2 * (y * z - w * x);
+        r[2][0] = 2 * (x * z - w * y);     r[2][1] = 2 * (y * z + w * x);     r[2][2] = 1 - 2 * (x * x + y * y);
+    }
+
+    static void to_body(const double r[3][3], const double v[3], double out[3]) {
+        for (int i = 0; i < 3; i++) out[i] = r[0][i] * v[0] + r[1][i] * v[1] + r[2][i] * v[2];
+    }
+
+    static void to_world(const double r[3][3], const double v[3], double out[3]) {
+        for (int i = 0; i < 3; i++) out[i] = r[i][0] * v[0] + r[i][1] * v[1] + r[i][2] * v[2];
+    }
+
+    void euler(double& roll, double& pitch, double& yaw) const {
+        double w = m_q[0], x = m_q[1], y = m_q[2], z = m_q[3];
+        roll = std::atan2(2 * (w * x + y * z), 1 - 2 * (x * x + y * y));
+        pitch = std::asin(std::min(1.0, std::max(-1.0, 2 * (w * y - z * x))));
+        yaw = std::atan2(2 * (w * z + x * y), 1 - 2 * (y * y + z * z));
+    }
+
+    void set_euler(double roll, double pitch, double yaw) {
+        double cr = std::cos(roll / 2), sr = std::sin(roll / 2);
+        double cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+        double cy = std::cos(yaw / 2), sy = std::sin(yaw / 2);
+        m_q[0] = cr * cp * cy + sr * sp * sy;
+        m_q[1] = sr * cp * cy - cr * sp * sy;
+        m_q[2] = cr * sp * cy + sr * cp * sy;
+        m_q[3] = cr * cp * sy - sr * sp * cy;
+    }
+
+    void integrate(double dt) {
+        const FlightModelParams& p = m_p;
+        if (m_crashed) return;
+
+        double aileron = (m_channels[0] - 0.5) * 2 * p.max_deflection;
+        double elevator = (m_channels[1] - 0.5) * 2 * p.max_deflection;
+        double throttle = m_channels[2];
+        double rudder = (m_channels[3] - 0.5) * 2 * p.max_deflection;
+        double flaps = m_channels[4];
+        double gear = m_channels[5];
+
+        double r[3][3];
+        rotation(r);
+
+        // Air-relative velocity in the body frame
+        double air[3] = {m_vel[0] - p.wind_north, m_vel[1] - p.wind_east, m_vel[2] - p.wind_down};
+        double vb[3];
+        to_body(r, air, vb);
+        double va = std::sqrt(vb[0] * vb[0] + vb[1] * vb[1] + vb[2] * vb[2]);
+        double alpha = std::atan2(vb[2], vb[0]);
+        double beta = va > 0.1 ? std::asin(std::min(1.0, std::max(-1.0, vb[1] / va))) : 0.0;
+        m_airspeed = va;
+
+        // Linear below the stall, flat plate above it
+        double stall = 1.0 / (1.0 + std::exp(-(std::fabs(alpha) - p.stall_alpha) / 0.03));
+        double cl_linear = p.cl0 + p.cl_alpha * alpha + p.cl_elevator * elevator + p.cl_flaps * flaps;
+        double cl = (1 - stall) * cl_linear + stall * std::sin(2 * alpha);
+        double cd = (1 - stall) * (p.cd0 + p.cd_induced * cl_linear * cl_linear) +
+                    stall * 2 * std::sin(alpha) * std::sin(alpha) +
+                    p.cd_flaps * flaps + p.cd_gear * gear;
+        double cy = p.cy_beta * beta + p.cy_rudder * rudder;
+
+        double ve = std::max(va, 1.0);  // rate damping terms at a standstill
+        double pn = m_rate[0] * p.span / (2 * ve);
+        double qn = m_rate[1] * p.chord / (2 * ve);
+        double rn = m_rate[2] * p.span / (2 * ve);
+        double c_roll = p.cl_beta * beta + p.cl_p * pn + p.cl_r * rn + p.cl_aileron * aileron;
+        double c_pitch = p.cm0 + p.cm_alpha * alpha + p.cm_q * qn + p.cm_elevator * elevator + p.cm_flaps * flaps;
+        double c_yaw = p.cn_beta * beta + p.cn_p * pn + p.cn_r * rn + p.cn_rudder * rudder + p.cn_aileron * aileron;
+
+        double qs = 0.5 * AIR_DENSITY * va * va * p.wing_area;
+        double ca = std::cos(alpha), sa = std::sin(alpha);
+        double thrust = p.max_thrust * throttle * std::max(0.0, 1.0 - vb[0] / p.prop_speed);
+        double fb[3] = {
+            qs * (-cd * ca + cl * sa) + thrust,
+            qs * cy,
+            qs * (-cd * sa - cl * ca),
+        };
+        double moment[3] = {qs * p.span * c_roll, qs * p.chord * c_pitch, qs * p.span * c_yaw};
+
+        // Translation
+        double fw[3];
+        to_world(r, fb, fw);
+        double accel[3] = {fw[0] / p.mass, fw[1] / p.mass, fw[2] / p.mass + GRAVITY};
+
+        // Rotation, diagonal inertia; a little structural damping for the
+        // standstill
+        const double inertia[3] = {p.ixx, p.iyy, p.izz};
+        double w[3] = {m_rate[0], m_rate[1], m_rate[2]};
+        double iw[3] = {p.ixx * w[0], p.iyy * w[1], p.izz * w[2]};
+        double gyro[3] = {w[1] * iw[2] - w[2] * iw[1], w[2] * iw[0] - w[0] * iw[2], w[0] * iw[1] - w[1] * iw[0]};
+        for (int i = 0; i < 3; i++) {
+            m_rate[i] += (moment[i] - gyro[i] - 0.01 * w[i]) / inertia[i] * dt;
+        }
+
+        // Resting on the wheels: the ground takes the weight, rolling
+        // friction along the heading, no side slip
+        double ground_d = -p.ground_asl;
+        if (m_pos[2] >= ground_d && accel[2] > 0) {
+            double normal = accel[2];
+            accel[2] = 0;
+            double yaw = std::atan2(2 * (m_q[0] * m_q[3] + m_q[1] * m_q[2]), 1 - 2 * (m_q[2] * m_q[2] + m_q[3] * m_q[3]));
+            double hn = std::cos(yaw), he = std::sin(yaw);
+            double a_along = accel[0] * hn + accel[1] * he;
+            double v_along = m_vel[0] * hn + m_vel[1] * he;
+            double friction = p.rolling_friction * normal * dt;
+            v_along = v_along > 0 ? std::max(0.0, v_along - friction) : std::min(0.0, v_along + friction);
+            accel[0] = a_along * hn;
+            accel[1] = a_along * he;
+            m_vel[0] = v_along * hn;
+            m_vel[1] = v_along * he;
+        }
+
+        for (int i = 0; i < 3; i++) {
+            m_vel[i] += accel[i] * dt;
+            m_pos[i] += m_vel[i] * dt;
+            m_accel[i] = accel[i];
+        }
+        m_force[0] = accel[0];
+        m_force[1] = accel[1];
+        m_force[2] = accel[2] - GRAVITY;
+
+        // q' = q * (0, w) / 2
+        double qw = m_q[0], qx = m_q[1], qy = m_q[2], qz = m_q[3];
+        double pr = m_rate[0], qr = m_rate[1], rr = m_rate[2];
+        m_q[0] += 0.5 * (-qx * pr - qy * qr - qz * rr) * dt;
+        m_q[1] += 0.5 * (qw * pr + qy * rr - qz * qr) * dt;
+        m_q[2] += 0.5 * (qw * qr - qx * rr + qz * pr) * dt;
+        m_q[3] += 0.5 * (qw * rr + qx * qr - qy * pr) * dt;
+        double norm = std::sqrt(m_q[0] * m_q[0] + m_q[1] * m_q[1] + m_q[2] * m_q[2] + m_q[3] * m_q[3]);
+        for (int i = 0; i < 4; i++) m_q[i] /= norm;
+
+        m_on_ground = m_pos[2] >= ground_d;
+        if (m_on_ground) touch_down(ground_d, rudder / p.max_deflection);
+        if (m_crashed) return;
+
+        // Motor and battery
+        m_rpm += (throttle * p.max_rpm - m_rpm) * std::min(1.0, dt / 0.1);
+        m_current = p.max_current * std::pow(throttle, 1.5);
+        m_used_mah += m_current * dt * (1000.0 / 3600.0);
+    }
+
+    // On (or into) the ground: level the wings, keep the nose at or above
+    // the horizon, steer with the nosewheel
+    void touch_down(double ground_d, double steer) {
+        const FlightModelParams& p = m_p;
+        double roll, pitch, yaw;
+        euler(roll, pitch, yaw);
+        if (m_vel[2] > p.crash_speed || std::fabs(roll) > 1.0 || pitch < -0.5) {
+            // Stays where it hit until reset()
+            m_crashed = true;
+            memset(m_vel, 0, sizeof(m_vel));
+            memset(m_accel, 0, sizeof(m_accel));
+            memset(m_rate, 0, sizeof(m_rate));
+            m_force[0] = m_force[1] = 0.0;
+            m_force[2] = -GRAVITY;
+            m_airspeed = 0.0;
+            m_rpm = 0.0;
+            m_current = 0.0;
+        }
+
+        m_pos[2] = ground_d;
+        if (m_vel[2] > 0) m_vel[2] = 0;
+        pitch = std::min(std::max(pitch, 0.0), 0.25);
+        set_euler(0.0, pitch, yaw);
+        m_rate[0] = 0;
+        if (pitch <= 0 && m_rate[1] < 0) m_rate[1] = 0;
+        double speed = std::hypot(m_vel[0], m_vel[1]);
+        m_rate[2] = steer * p.steer_rate * std::min(speed, 10.0);
+    }
+
+    FlightModelParams m_p;
+    double m_time;
+    double m_pos[3];      // NED from the field origin, m
+    double m_vel[3];      // NED, m/s
+    double m_accel[3];    // NED, m/s^2
+    double m_force[3];    // specific force (what an accelerometer reads), NED, m/s^2
+    double m_q[4];        // body -> NED, (w, x, y, z)
+    double m_rate[3];     // body p, q, r, rad/s
+    double m_channels[NUM_RCIN];
+    double m_airspeed;
+    double m_rpm;
+    double m_current;
+    double m_used_mah;
+    bool m_on_ground;
+    bool m_crashed;
+};
+
+} // namespace RF
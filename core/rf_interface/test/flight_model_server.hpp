@@ -0,0 +1,133 @@
+#pragma once
+
+#include "mock_link_server.hpp"
+#include "flight_model.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace RF {
+
+// MockLinkServer that flies a FlightModel instead of the synthetic orbit:
+// the request's channels drive the model, the reply carries every tag of
+// telemetry_schema from it. Nothing is allocated per request once the reply
+// string has grown to size.
+//
+// Lockstep: each ExchangeData request advances physics by exactly one step,
+// so a client runs the sim as fast as it can exchange, and every run with
+// the same commands is the same flight (physics time then has nothing to
+// do with the wall clock, and RFInterface::sim_clock() keeps resyncing).
+// Otherwise physics follows the wall
+// clock at set_speed() times real time (RealFlight's speed multiplier) in
+// whole steps; requests faster than the step rate see the same step again.
+//
+// ResetAircraft puts the aircraft back at its start; physics time keeps
+// counting, as RFInterface orders replies by it.
+class FlightModelServer : public MockLinkServer {
+public:
+    explicit FlightModelServer(uint16_t port = 18083, const char* bind_ip = "127.0.0.1",
+                               const FlightModelParams& params = FlightModelParams())
+        : MockLinkServer(port, bind_ip), m_model(params) {}
+
+    // Set before serving
+    void set_lockstep(bool on) { m_lockstep = on; }
+    void set_speed(double speed) { m_speed = speed > 0 ? speed : 1.0; }
+    void set_step_rate(double hz) { m_step_s = 1.0 / (hz > 0 ? hz : DEFAULT_STEP_RATE); }
+
+    bool lockstep() const { return m_lockstep; }
+    double speed() const { return m_speed; }
+    double step_rate() const { return 1.0 / m_step_s; }
+    uint64_t steps() const { return m_steps.load(); }
+
+    // Serving thread only
+    const FlightModel& model() const { return m_model; }
+
+    static constexpr double DEFAULT_STEP_RATE = 200.0;  // Hz
+    // Free-running: after a stall (or a client that stopped asking), do at
+    // most this much physics in one reply and let the rest go
+    static constexpr double MAX_CATCH_UP_S = 0.25;
+
+protected:
+    void exchange_reply(const char* body, size_t len, std::string& reply) override {
+        double channels[NUM_RCIN];
+        for (int i = 0; i < NUM_RCIN; i++) channels[i] = 0.5;
+        parse_channels(body, len, channels);
+        m_model.set_controls(channels);
+
+        uint64_t due = m_physics_steps + 1;
+        if (!m_lockstep) {
+            auto now = std::chrono::steady_clock::now();
+            if (!m_started) {
+                m_start = now;
+                m_started = true;
+            }
+            double wall = std::chrono::duration<double>(now - m_start).count();
+            due = static_cast<uint64_t>(std::floor(wall * m_speed / m_step_s));
+            uint64_t max_steps = static_cast<uint64_t>(MAX_CATCH_UP_S / m_step_s);
+            if (due > m_physics_steps + max_steps) {
+                // Fall behind the wall clock rather than stall the client
+                m_start += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>((due - m_physics_steps - max_steps) * m_step_s / m_speed));
+                due = m_physics_steps + max_steps;
+            }
+        }
+        for (; m_physics_steps < due; m_physics_steps++) {
+            m_model.step(m_step_s);
+        }
+        m_steps.store(m_physics_steps);
+
+        m_model.telemetry(m_state);
+        m_state.m_currentPhysicsTime_SEC = m_physics_steps * m_step_s;
+        m_state.m_currentPhysicsSpeedMultiplier = m_lockstep ? 1.0 : m_speed;
+
+        reply.clear();
+        reply += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                 "<SOAP-ENV:Envelope xmlns:SOAP-ENV=\"http://schemas.xmlsoap.org/soap/envelope/\" "
+                 "xmlns:SOAP-ENC=\"http://schemas.xmlsoap.org/soap/encoding/\" "
+                 "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+                 "xmlns:xsd=\"http://www.w3.org/2001/XMLSchema\">"
+                 "<SOAP-ENV:Body><ReturnData><m-previousInputsState>"
+                 "<m-selectedChannels>-1</m-selectedChannels>"
+                 "<m-channelValues-0to1 xsi:type=\"SOAP-ENC:Array\" SOAP-ENC:arrayType=\"xsd:double[12]\">";
+        for (int i = 0; i < NUM_RCIN; i++) {
+            append_value(reply, "item", m_state.rcin[i]);
+        }
+        reply += "</m-channelValues-0to1></m-previousInputsState><m-aircraftState>";
+
+        for (int i = 0; i < NUM_TELEMETRY_TAGS; i++) {
+            const TelemetryField& field = telemetry_schema[i];
+            if (field.offset == offsetof(AircraftState, m_resetButtonHasBeenPressed)) continue;  // in m-notifications
+            double value = telemetry_value(m_state, i);
+            if (strcmp(field.unit, "bool") == 0) {
+                append_bool(reply, field.tag, value != 0.0);
+            } else {
+                append_value(reply, field.tag, value);
+            }
+        }
+        reply += "</m-aircraftState><m-notifications>";
+        append_bool(reply, "m-resetButtonHasBeenPressed", false);
+        reply += "</m-notifications></ReturnData></SOAP-ENV:Body></SOAP-ENV:Envelope>";
+    }
+
+    void reset() override {
+        m_model.reset();
+    }
+
+private:
+    FlightModel m_model;
+    AircraftState m_state;
+    bool m_lockstep = false;
+    double m_speed = 1.0;
+    double m_step_s = 1.0 / DEFAULT_STEP_RATE;
+
+    uint64_t m_physics_steps = 0;  // since the first request, across resets
+    std::atomic<uint64_t> m_steps{0};
+    bool m_started = false;
+    std::chrono::steady_clock::time_point m_start;  // free-running: wall time of step 0
+};
+
+} // namespace RF
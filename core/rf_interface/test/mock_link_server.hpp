@@ -0,0 +1,460 @@
+#pragma once
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace RF {
+
+// Local stand-in for the RealFlight Link SOAP server, so RFInterface can be
+// exercised and benchmarked on a plain Linux box without RealFlight.
+//
+// Speaks the same protocol as RealFlight: one HTTP POST per TCP connection,
+// action selected by the Soapaction header, connection closed after the reply.
+// Idle pre-connected sockets (see SocketPool) are accepted and held until they
+// carry a request or the client closes them.
+//
+// exchange_reply() can be overridden to serve something other than the
+// built-in synthetic flight.
+class MockLinkServer {
+public:
+    explicit MockLinkServer(uint16_t port = 18083, const char* bind_ip = "127.0.0.1")
+        : m_port(port), m_bind_ip(bind_ip) {}
+
+    virtual ~MockLinkServer() {
+        stop();
+    }
+
+    // Bind and listen. Returns false if the port cannot be opened
+    bool open_listener() {
+        m_listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (m_listen_fd < 0) {
+            std::cerr << "[ERROR] MockLinkServer: socket failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        int one = 1;
+        setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(m_port);
+        if (inet_pton(AF_INET, m_bind_ip, &addr.sin_addr) <= 0) {
+            std::cerr << "[ERROR] MockLinkServer: invalid address " << m_bind_ip << std::endl;
+            return false;
+        }
+
+        if (bind(m_listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+            listen(m_listen_fd, 128) < 0) {
+            std::cerr << "[ERROR] MockLinkServer: cannot listen on " << m_bind_ip << ":" << m_port
+                      << ": " << strerror(errno) << std::endl;
+            close(m_listen_fd);
+            m_listen_fd = -1;
+            return false;
+        }
+
+        m_epoll_fd = epoll_create1(0);
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = m_listen_fd;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_listen_fd, &ev);
+        return true;
+    }
+
+    // Serve on a background thread
+    bool start() {
+        if (m_listen_fd < 0 && !open_listener()) return false;
+        m_running.store(true);
+        m_thread = std::thread(&MockLinkServer::run, this);
+        return true;
+    }
+
+    void stop() {
+        m_running.store(false);
+        if (m_thread.joinable()) m_thread.join();
+
+        for (auto& conn : m_conns) close(conn.first);
+        m_conns.clear();
+        for (auto& d : m_delayed) close(d.fd);
+        m_delayed.clear();
+        if (m_epoll_fd >= 0) close(m_epoll_fd);
+        if (m_listen_fd >= 0) close(m_listen_fd);
+        m_epoll_fd = -1;
+        m_listen_fd = -1;
+    }
+
+    // Serve on the calling thread until stop() or request_stop()
+    void run() {
+        if (m_listen_fd < 0 && !open_listener()) return;
+        m_running.store(true);
+
+        struct epoll_event events[64];
+        while (m_running.load()) {
+            int timeout_ms = 100;
+            if (!m_delayed.empty()) {
+                auto wait = m_delayed.front().due - std::chrono::steady_clock::now();
+                timeout_ms = std::max<int>(0, std::chrono::ceil<std::chrono::milliseconds>(wait).count());
+            }
+
+            int n = epoll_wait(m_epoll_fd, events, 64, timeout_ms);
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                if (fd == m_listen_fd) {
+                    accept_all();
+                } else {
+                    service(fd);
+                }
+            }
+            flush_delayed();
+        }
+    }
+
+    void request_stop() {
+        m_running.store(false);
+    }
+
+    // Hold every reply back by this long, to emulate the network and the
+    // simulator's own processing time. Other connections keep being served.
+    void set_reply_delay(std::chrono::microseconds delay) {
+        m_reply_delay = delay;
+    }
+
+    // Advance physics time in steps of 1/hz, as RealFlight does, so requests
+    // faster than that see the same step more than once. 0 (default):
+    // continuous, every reply is a new step.
+    void set_physics_rate(double hz) {
+        m_physics_hz = hz;
+    }
+
+    // Leave m-currentPhysicsTime-SEC out of every nth ExchangeData reply, as
+    // a broken or truncated endpoint would. 0 (default): never.
+    void set_drop_physics_time(uint64_t every) {
+        m_drop_physics_time = every;
+    }
+
+    uint16_t port() const { return m_port; }
+    uint64_t exchanges_served() const { return m_exchanges.load(); }
+    uint64_t requests_served() const { return m_requests.load(); }
+
+protected:
+    // Fill `reply` with the SOAP envelope for one ExchangeData request.
+    // `body` is the request envelope as received.
+    virtual void exchange_reply(const char* body, size_t len, std::string& reply) {
+        double channels[12];
+        for (int i = 0; i < 12; i++) channels[i] = 0.5;
+        parse_channels(body, len, channels);
+
+        double t = physics_time();
+
+        // Gentle left-hand orbit at 100 m, enough to make every field move
+        const double radius = 150.0, speed = 20.0;
+        double w = speed / radius;
+        double heading = std::fmod(90.0 + w * t * 180.0 / M_PI, 360.0);
+
+        reply.clear();
+        reply += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                 "<SOAP-ENV:Envelope xmlns:SOAP-ENV=\"http://schemas.xmlsoap.org/soap/envelope/\" "
+                 "xmlns:SOAP-ENC=\"http://schemas.xmlsoap.org/soap/encoding/\" "
+                 "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+                 "xmlns:xsd=\"http://www.w3.org/2001/XMLSchema\">"
+                 "<SOAP-ENV:Body><ReturnData><m-previousInputsState>"
+                 "<m-selectedChannels>-1</m-selectedChannels>"
+                 "<m-channelValues-0to1 xsi:type=\"SOAP-ENC:Array\" SOAP-ENC:arrayType=\"xsd:double[12]\">";
+        for (int i = 0; i < 12; i++) {
+            append_value(reply, "item", channels[i]);
+        }
+        reply += "</m-channelValues-0to1></m-previousInputsState><m-aircraftState>";
+
+        if (m_drop_physics_time == 0 || ++m_replies_built % m_drop_physics_time != 0) {
+            append_value(reply, "m-currentPhysicsTime-SEC", t);
+        }
+        append_value(reply, "m-currentPhysicsSpeedMultiplier", 1.0);
+        append_value(reply, "m-airspeed-MPS", speed + 0.5 * std::sin(t));
+        append_value(reply, "m-altitudeASL-MTR", 100.0 + 2.0 * std::sin(0.3 * t));
+        append_value(reply, "m-altitudeAGL-MTR", 100.0 + 2.0 * std::sin(0.3 * t));
+        append_value(reply, "m-groundspeed-MPS", speed);
+        append_value(reply, "m-pitchRate-DEGpSEC", 0.6 * std::cos(0.3 * t));
+        append_value(reply, "m-rollRate-DEGpSEC", 0.0);
+        append_value(reply, "m-yawRate-DEGpSEC", w * 180.0 / M_PI);
+        append_value(reply, "m-azimuth-DEG", heading > 180.0 ? heading - 360.0 : heading);
+        append_value(reply, "m-inclination-DEG", 2.0 * std::sin(0.3 * t));
+        append_value(reply, "m-roll-DEG", -15.0);
+        append_value(reply, "m-orientationQuaternion-X", 0.13);
+        append_value(reply, "m-orientationQuaternion-Y", 0.0);
+        append_value(reply, "m-orientationQuaternion-Z", std::sin(0.5 * w * t));
+        append_value(reply, "m-orientationQuaternion-W", std::cos(0.5 * w * t));
+        append_value(reply, "m-aircraftPositionX-MTR", radius * std::cos(w * t));
+        append_value(reply, "m-aircraftPositionY-MTR", radius * std::sin(w * t));
+        append_value(reply, "m-velocityWorldU-MPS", -speed * std::sin(w * t));
+        append_value(reply, "m-velocityWorldV-MPS", speed * std::cos(w * t));
+        append_value(reply, "m-velocityWorldW-MPS", 0.0);
+        append_value(reply, "m-velocityBodyU-MPS", speed);
+        append_value(reply, "m-velocityBodyV-MPS", 0.0);
+        append_value(reply, "m-velocityBodyW-MPS", 0.0);
+        append_value(reply, "m-accelerationWorldAX-MPS2", -speed * w * std::cos(w * t));
+        append_value(reply, "m-accelerationWorldAY-MPS2", -speed * w * std::sin(w * t));
+        append_value(reply, "m-accelerationWorldAZ-MPS2", 0.0);
+        append_value(reply, "m-accelerationBodyAX-MPS2", 0.0);
+        append_value(reply, "m-accelerationBodyAY-MPS2", speed * w);
+        append_value(reply, "m-accelerationBodyAZ-MPS2", -9.81);
+        append_value(reply, "m-windX-MPS", 0.0);
+        append_value(reply, "m-windY-MPS", 0.0);
+        append_value(reply, "m-windZ-MPS", 0.0);
+        append_value(reply, "m-propRPM", 4000.0 + 8000.0 * channels[2]);
+        append_value(reply, "m-heliMainRotorRPM", -1.0);
+        append_value(reply, "m-batteryVoltage-VOLTS", 12.4);
+        append_value(reply, "m-batteryCurrentDraw-AMPS", 20.0 * channels[2]);
+        append_value(reply, "m-batteryRemainingCapacity-MAH", 2200.0 - t * 0.1);
+        append_value(reply, "m-fuelRemaining-OZ", -1.0);
+        append_bool(reply, "m-isLocked", false);
+        append_bool(reply, "m-hasLostComponents", false);
+        append_bool(reply, "m-anEngineIsRunning", true);
+        append_bool(reply, "m-isTouchingGround", false);
+        append_bool(reply, "m-flightAxisControllerIsActive", m_injected);
+        reply += "<m-currentAircraftStatus>CAS-FLYING</m-currentAircraftStatus>";
+
+        reply += "</m-aircraftState><m-notifications>";
+        append_bool(reply, "m-resetButtonHasBeenPressed", false);
+        reply += "</m-notifications></ReturnData></SOAP-ENV:Body></SOAP-ENV:Envelope>";
+    }
+
+    // Called for ResetAircraft
+    virtual void reset() {
+        m_epoch = std::chrono::steady_clock::now();
+    }
+
+    // How long to hold back the reply just built. Defaults to
+    // set_reply_delay(); subclasses can vary it per reply.
+    virtual std::chrono::microseconds reply_delay() {
+        return m_reply_delay;
+    }
+
+    // Seconds since the epoch, on the set_physics_rate() grid
+    double physics_time() const {
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_epoch).count();
+        return m_physics_hz > 0 ? std::floor(t * m_physics_hz) / m_physics_hz : t;
+    }
+
+    static void append_value(std::string& out, const char* tag, double value) {
+        char buf[160];
+        int n = snprintf(buf, sizeof(buf), "<%s>%.10g</%s>", tag, value, tag);
+        out.append(buf, n);
+    }
+
+    static void append_bool(std::string& out, const char* tag, bool value) {
+        char buf[128];
+        int n = snprintf(buf, sizeof(buf), "<%s>%s</%s>", tag, value ? "true" : "false", tag);
+        out.append(buf, n);
+    }
+
+    // Pull the 12 <item> values out of an ExchangeData request body
+    static void parse_channels(const char* body, size_t len, double channels[12]) {
+        const char* p = body;
+        const char* end = body + len;
+        for (int i = 0; i < 12; i++) {
+            const char* item = static_cast<const char*>(memmem(p, end - p, "<item>", 6));
+            if (!item) break;
+            channels[i] = strtod(item + 6, nullptr);
+            p = item + 6;
+        }
+    }
+
+    std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+    bool m_injected = false;
+    double m_physics_hz = 0;
+    uint64_t m_drop_physics_time = 0;
+    uint64_t m_replies_built = 0;
+
+private:
+    void accept_all() {
+        while (true) {
+            int fd = accept4(m_listen_fd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0) return;
+
+            struct epoll_event ev;
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.fd = fd;
+            epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+            m_conns[fd].clear();
+        }
+    }
+
+    void drop(int fd) {
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        m_conns.erase(fd);
+    }
+
+    void service(int fd) {
+        std::string& in = m_conns[fd];
+        char buf[8192];
+        while (true) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                in.append(buf, n);
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                drop(fd);
+                return;
+            }
+            break;
+        }
+
+        // Wait for the full header block, then for Content-Length bytes of body
+        size_t header_end = in.find("\r\n\r\n");
+        if (header_end == std::string::npos) return;
+        size_t body_start = header_end + 4;
+
+        size_t content_length = 0;
+        const char* cl = strcasestr_n(in.c_str(), header_end, "Content-Length:");
+        if (cl) content_length = strtoul(cl + 15, nullptr, 10);
+        if (in.size() < body_start + content_length) return;
+
+        char action[64] = "";
+        const char* sa = strcasestr_n(in.c_str(), header_end, "Soapaction:");
+        if (sa) {
+            sa += 11;
+            while (*sa == ' ' || *sa == '\'' || *sa == '"') sa++;
+            size_t i = 0;
+            while (i < sizeof(action) - 1 && sa[i] && sa[i] != '\'' && sa[i] != '"' && sa[i] != '\r') {
+                action[i] = sa[i];
+                i++;
+            }
+            action[i] = '\0';
+        }
+
+        respond(action, in.c_str() + body_start, content_length);
+
+        auto delay = reply_delay();
+        if (delay.count() > 0) {
+            epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            m_conns.erase(fd);
+
+            // Kept in due order; with a constant delay this is always the back
+            Delayed d{fd, std::chrono::steady_clock::now() + delay, m_reply};
+            auto pos = std::upper_bound(m_delayed.begin(), m_delayed.end(), d,
+                                        [](const Delayed& a, const Delayed& b) { return a.due < b.due; });
+            m_delayed.insert(pos, std::move(d));
+        } else {
+            send_all(fd, m_reply);
+            drop(fd);
+        }
+    }
+
+    void flush_delayed() {
+        auto now = std::chrono::steady_clock::now();
+        while (!m_delayed.empty() && m_delayed.front().due <= now) {
+            send_all(m_delayed.front().fd, m_delayed.front().reply);
+            close(m_delayed.front().fd);
+            m_delayed.pop_front();
+        }
+    }
+
+    // Build the full HTTP reply for `action` into m_reply
+    void respond(const char* action, const char* body, size_t len) {
+        m_requests.fetch_add(1);
+
+        if (strcmp(action, "ExchangeData") == 0) {
+            exchange_reply(body, len, m_reply_body);
+            m_exchanges.fetch_add(1);
+        } else if (strcmp(action, "InjectUAVControllerInterface") == 0) {
+            m_injected = true;
+            simple_reply(action);
+        } else if (strcmp(action, "RestoreOriginalControllerDevice") == 0) {
+            m_injected = false;
+            simple_reply(action);
+        } else if (strcmp(action, "ResetAircraft") == 0) {
+            reset();
+            simple_reply(action);
+        } else {
+            m_reply = "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            return;
+        }
+
+        char header[256];
+        int n = snprintf(header, sizeof(header),
+                         "HTTP/1.1 200 OK\r\n"
+                         "Server: gSOAP/2.7\r\n"
+                         "Content-Type: text/xml; charset=utf-8\r\n"
+                         "Content-Length: %zu\r\n"
+                         "Connection: close\r\n"
+                         "\r\n", m_reply_body.size());
+        m_reply.assign(header, n);
+        m_reply += m_reply_body;
+    }
+
+    void simple_reply(const char* action) {
+        m_reply_body.clear();
+        m_reply_body += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                        "<SOAP-ENV:Envelope xmlns:SOAP-ENV=\"http://schemas.xmlsoap.org/soap/envelope/\">"
+                        "<SOAP-ENV:Body><";
+        m_reply_body += action;
+        m_reply_body += "Response/></SOAP-ENV:Body></SOAP-ENV:Envelope>";
+    }
+
+    static void send_all(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                sent += n;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            } else {
+                return;
+            }
+        }
+    }
+
+    // Case-insensitive search limited to the first `len` bytes
+    static const char* strcasestr_n(const char* hay, size_t len, const char* needle) {
+        size_t nlen = strlen(needle);
+        for (size_t i = 0; i + nlen <= len; i++) {
+            if (strncasecmp(hay + i, needle, nlen) == 0) return hay + i;
+        }
+        return nullptr;
+    }
+
+    uint16_t m_port;
+    const char* m_bind_ip;
+    int m_listen_fd = -1;
+    int m_epoll_fd = -1;
+    std::atomic_bool m_running{false};
+    std::thread m_thread;
+
+    std::unordered_map<int, std::string> m_conns;
+    std::string m_reply_body;
+    std::string m_reply;
+
+    struct Delayed {
+        int fd;
+        std::chrono::steady_clock::time_point due;
+        std::string reply;
+    };
+    std::chrono::microseconds m_reply_delay{0};
+    std::deque<Delayed> m_delayed;
+
+    std::atomic<uint64_t> m_requests{0};
+    std::atomic<uint64_t> m_exchanges{0};
+};
+
+} // namespace RF
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "mock_link_server.hpp"
+#include "wire_capture.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RF {
+
+// Serves a session recorded with RFInterface::start_capture() back to a
+// client: the n-th ExchangeData request gets the n-th captured reply.
+//
+// Replies are paced by the capture timestamps, divided by the speed factor
+// (1 = as recorded, 10 = ten times faster). Speed 0 answers as fast as the
+// client asks. A client slower than the pacing just gets each reply at once.
+class ReplayServer : public MockLinkServer {
+public:
+    explicit ReplayServer(uint16_t port = 18083, const char* bind_ip = "127.0.0.1")
+        : MockLinkServer(port, bind_ip) {}
+
+    // Pull the ExchangeData replies out of a capture, in request order
+    bool load(const char* path) {
+        std::vector<CaptureEntry> entries;
+        if (!read_wire_capture(path, entries)) return false;
+
+        std::unordered_map<uint64_t, bool> is_exchange;
+        for (const CaptureEntry& e : entries) {
+            if (e.kind == CAPTURE_REQUEST) {
+                is_exchange[e.id] = e.bytes.find("ExchangeData") != std::string::npos;
+            }
+        }
+
+        m_frames.clear();
+        for (const CaptureEntry& e : entries) {
+            if (e.kind != CAPTURE_RESPONSE || !is_exchange[e.id]) continue;
+            size_t body = e.bytes.find("\r\n\r\n");
+            if (body == std::string::npos) continue;  // reply cut short when captured
+            m_frames.push_back({e.id, e.host_time_ns, e.bytes.substr(body + 4)});
+        }
+        std::sort(m_frames.begin(), m_frames.end(),
+                  [](const Frame& a, const Frame& b) { return a.id < b.id; });
+
+        if (m_frames.empty()) {
+            std::cerr << "[ERROR] ReplayServer: no ExchangeData replies in " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void set_speed(double speed) { m_speed = speed; }
+
+    // Start over from the first frame at the end instead of repeating the last
+    void set_loop(bool loop) { m_loop = loop; }
+
+    size_t frames() const { return m_frames.size(); }
+    double captured_seconds() const {
+        return m_frames.empty() ? 0.0 : (m_frames.back().host_time_ns - m_frames.front().host_time_ns) / 1e9;
+    }
+
+protected:
+    void exchange_reply(const char*, size_t, std::string& reply) override {
+        auto now = std::chrono::steady_clock::now();
+        if (m_next == 0) m_start = now;
+
+        const Frame& frame = m_frames[std::min(m_next, m_frames.size() - 1)];
+        reply = frame.body;
+
+        // Due time of this frame on the replay clock
+        m_delay = std::chrono::microseconds(0);
+        if (m_speed > 0) {
+            auto offset = std::chrono::nanoseconds(
+                static_cast<int64_t>((frame.host_time_ns - m_frames.front().host_time_ns) / m_speed));
+            auto wait = std::chrono::duration_cast<std::chrono::microseconds>(m_start + offset - now);
+            if (wait.count() > 0) m_delay = wait;
+        }
+
+        if (++m_next >= m_frames.size()) {
+            if (m_loop) {
+                m_next = 0;
+            } else if (!m_exhausted) {
+                m_exhausted = true;
+                std::cout << "[INFO] ReplayServer: capture exhausted, repeating the last frame" << std::endl;
+            }
+        }
+    }
+
+    std::chrono::microseconds reply_delay() override {
+        auto delay = m_delay;
+        m_delay = std::chrono::microseconds(0);
+        return delay;
+    }
+
+private:
+    struct Frame {
+        uint64_t id;
+        int64_t host_time_ns;
+        std::string body;
+    };
+
+    std::vector<Frame> m_frames;
+    size_t m_next = 0;
+    double m_speed = 1.0;
+    bool m_loop = false;
+    bool m_exhausted = false;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::microseconds m_delay{0};
+};
+
+} // namespace RF
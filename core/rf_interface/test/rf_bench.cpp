@@ -0,0 +1,501 @@
+// End-to-end loop benchmark for RFInterface::exchange_data().
+//
+// By default forks a MockLinkServer on loopback so it runs anywhere; pass
+// --host to measure against a real RealFlight box (or an rf_mock_server
+// running elsewhere) instead.
+//
+// Also counts heap allocations made on the exchange thread, for both the
+// request builder on its own and the full exchange.
+//
+// --pipeline N runs the update() loop with N requests in flight for
+// --seconds S instead, and reports accepted frames/sec. --latency-us makes
+// the forked mock server hold each reply back, to emulate a remote simulator.
+//
+// --record FILE logs every command and state through the flight recorder
+// while benchmarking (inspect with rf_log_dump). --capture FILE saves the raw
+// SOAP traffic for rf_replay_server; --replay FILE serves such a capture
+// (at --speed, 0 = full speed) instead of the synthetic flight, and parses its
+// replies in the parse microbenchmark.
+//
+// --physics-hz H has the forked mock server step physics time at H Hz, as
+// RealFlight does, so requests faster than that get repeated steps (counted
+// and dropped, see RFInterface::wait_for_state).
+//
+// --drop-physics-time N has the forked mock server leave the physics time
+// out of every Nth reply; those must be dropped as malformed, never
+// published (exits 1 otherwise).
+//
+// --uring runs the serial exchanges through io_uring (set_io_uring) instead
+// of the socket pool path. Syscalls per exchange are counted with the
+// raw_syscalls:sys_enter tracepoint when tracefs is mounted and perf events
+// are allowed (e.g. as root: mount -t tracefs nodev /sys/kernel/tracing).
+//
+// Usage: rf_bench [-n exchanges] [--host ip] [--port port]
+//                 [--pipeline depth] [--seconds s] [--latency-us us]
+//                 [--rate hz] [--fifo prio] [--cpu n] [--mlock] [--record file]
+//                 [--capture file] [--replay file] [--speed factor] [--uring]
+//                 [--physics-hz hz] [--drop-physics-time n]
+
+#include "RFInterface.hpp"
+#include "soap_request.hpp"
+#include "reply_parser.hpp"
+#include "mock_link_server.hpp"
+#include "replay_server.hpp"
+#include "alloc_counter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <signal.h>
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace RF;
+
+static double cpu_seconds() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6 +
+           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
+}
+
+// Syscalls made by this process (all threads started after open()), through
+// a perf counter on the raw_syscalls:sys_enter tracepoint
+class SyscallCounter {
+public:
+    bool open() {
+        const char* paths[] = {"/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+                               "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id"};
+        int id = -1;
+        for (const char* path : paths) {
+            if (FILE* f = fopen(path, "r")) {
+                if (fscanf(f, "%d", &id) != 1) id = -1;
+                fclose(f);
+                if (id >= 0) break;
+            }
+        }
+        if (id < 0) return false;
+
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_TRACEPOINT;
+        attr.size = sizeof(attr);
+        attr.config = id;
+        attr.inherit = 1;
+        m_fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        return m_fd >= 0;
+    }
+
+    bool ok() const { return m_fd >= 0; }
+
+    uint64_t read_count() const {
+        uint64_t count = 0;
+        if (m_fd < 0 || read(m_fd, &count, sizeof(count)) != sizeof(count)) return 0;
+        return count;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+// Run the mock server in a child process so its CPU time is not billed to us
+static pid_t spawn_mock_server(uint16_t port, int latency_us, const char* replay_path, double speed,
+                               double physics_hz, uint64_t drop_physics_time) {
+    int ready[2];
+    if (pipe(ready) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        std::unique_ptr<MockLinkServer> owned;
+        bool ok = true;
+        if (replay_path) {
+            auto replay = std::make_unique<ReplayServer>(port);
+            ok = replay->load(replay_path);
+            replay->set_speed(speed);
+            replay->set_loop(true);
+            owned = std::move(replay);
+        } else {
+            owned = std::make_unique<MockLinkServer>(port);
+        }
+        MockLinkServer& server = *owned;
+        server.set_reply_delay(std::chrono::microseconds(latency_us));
+        server.set_physics_rate(physics_hz);
+        server.set_drop_physics_time(drop_physics_time);
+        ok = ok && server.open_listener();
+        char c = ok ? 1 : 0;
+        if (write(ready[1], &c, 1) != 1 || !ok) _exit(1);
+        close(ready[1]);
+
+        static MockLinkServer* s_server = &server;
+        signal(SIGTERM, [](int) { s_server->request_stop(); });
+        server.run();
+        _exit(0);
+    }
+
+    close(ready[1]);
+    char c = 0;
+    if (pid < 0 || read(ready[0], &c, 1) != 1 || c != 1) {
+        close(ready[0]);
+        return -1;
+    }
+    close(ready[0]);
+    return pid;
+}
+
+// Exposes the mock server's reply generator as a parse fixture
+struct ReplyFixture : MockLinkServer {
+    std::string make() {
+        std::string reply;
+        const char* body = "<item>0.5</item>";
+        exchange_reply(body, strlen(body), reply);
+        return reply;
+    }
+};
+
+static void print_sim_clock(const RFInterface& sim) {
+    ClockEstimate clock = sim.sim_clock();
+    printf("repeated steps   : %llu dropped\n", (unsigned long long)sim.repeated_replies_dropped());
+    printf("malformed replies: %llu dropped\n", (unsigned long long)sim.malformed_replies_dropped());
+    if (clock.valid) {
+        printf("sim clock        : x%.2f, drift %.1f ppm, one-way delay %.1f us, %llu resyncs\n",
+               clock.speed_multiplier, clock.drift_ppm, clock.one_way_delay_ns / 1e3,
+               (unsigned long long)clock.resyncs);
+    }
+}
+
+// --drop-physics-time: the replies without a physics time were dropped, and
+// none of them made it into the published state
+static bool check_malformed(const RFInterface& sim) {
+    if (sim.malformed_replies_dropped() == 0) {
+        std::cerr << "[ERROR] Replies without a physics time were not dropped" << std::endl;
+        return false;
+    }
+    if (sim.get_state().state.m_currentPhysicsTime_SEC < 0) {
+        std::cerr << "[ERROR] A reply without a physics time was published" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+int main(int argc, char* argv[]) {
+    int count = 5000;
+    const char* host = nullptr;
+    uint16_t port = 18090;
+    int pipeline = 0;
+    double seconds = 3.0;
+    int latency_us = 0;
+    SchedulerConfig sched;
+    const char* record_path = nullptr;
+    const char* capture_path = nullptr;
+    const char* replay_path = nullptr;
+    double replay_speed = 0.0;
+    double physics_hz = 0.0;
+    uint64_t drop_physics_time = 0;
+    bool use_uring = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            count = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--host") && i + 1 < argc) {
+            host = argv[++i];
+        } else if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+            port = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--pipeline") && i + 1 < argc) {
+            pipeline = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--latency-us") && i + 1 < argc) {
+            latency_us = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            sched.rate_hz = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--fifo") && i + 1 < argc) {
+            sched.fifo_priority = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--cpu") && i + 1 < argc) {
+            sched.cpu = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--mlock")) {
+            sched.lock_memory = true;
+        } else if (!strcmp(argv[i], "--record") && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (!strcmp(argv[i], "--capture") && i + 1 < argc) {
+            capture_path = argv[++i];
+        } else if (!strcmp(argv[i], "--replay") && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (!strcmp(argv[i], "--speed") && i + 1 < argc) {
+            replay_speed = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--physics-hz") && i + 1 < argc) {
+            physics_hz = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--drop-physics-time") && i + 1 < argc) {
+            drop_physics_time = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--uring")) {
+            use_uring = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [-n exchanges] [--host ip] [--port port]"
+                      << " [--pipeline depth] [--seconds s] [--latency-us us]"
+                      << " [--rate hz] [--fifo prio] [--cpu n] [--mlock] [--record file]"
+                      << " [--capture file] [--replay file] [--speed factor] [--uring]"
+                      << " [--physics-hz hz] [--drop-physics-time n]" << std::endl;
+            return 1;
+        }
+    }
+
+    pid_t server_pid = -1;
+    if (!host) {
+        server_pid = spawn_mock_server(port, latency_us, replay_path, replay_speed, physics_hz,
+                                       drop_physics_time);
+        if (server_pid < 0) {
+            std::cerr << "[ERROR] Could not start mock server on port " << port << std::endl;
+            return 1;
+        }
+        host = "127.0.0.1";
+    }
+
+    // Request builder on its own
+    {
+        ExchangeRequest request;
+        double channels[ExchangeRequest::NUM_CHANNELS] = {0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0, 0.5, 0.5, 0.5, 0.5};
+        const int iterations = 1000000;
+        volatile size_t sink = 0;
+
+        uint64_t allocs_start = t_allocations;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            channels[0] = (i % 1000) / 1000.0;
+            request.set_channels(channels);
+            sink = sink + request.size();
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        printf("request build    : %.1f ns/op, %.2f allocs/op (%zu bytes)\n",
+               std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations,
+               double(t_allocations - allocs_start) / iterations, request.size());
+    }
+
+    // Reply parser on its own, over the synthetic reply or every captured one
+    {
+        std::vector<std::string> replies;
+        if (replay_path) {
+            std::vector<CaptureEntry> entries;
+            read_wire_capture(replay_path, entries);
+            for (const CaptureEntry& e : entries) {
+                size_t body = e.bytes.find("\r\n\r\n");
+                if (e.kind == CAPTURE_RESPONSE && body != std::string::npos &&
+                    e.bytes.find("<ReturnData>") != std::string::npos) {
+                    replies.push_back(e.bytes.substr(body + 4));
+                }
+            }
+        }
+        if (replies.empty()) replies.push_back(ReplyFixture().make());
+
+        // Everything, then only what an attitude/position consumer asks for
+        auto bench_parse = [&](const char* label, TelemetryMask wanted) {
+            AircraftState parsed;
+            const int iterations = 200000;
+            size_t bytes = 0;
+            int decoded = 0;
+
+            uint64_t allocs_start = t_allocations;
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++) {
+                const std::string& reply = replies[i % replies.size()];
+                decoded = scan_reply(reply.data(), reply.data() + reply.size(),
+                                     [&](int idx, double v) { parsed.rcin[idx] = v; },
+                                     [&](int idx, double v) { telemetry_value(parsed, idx) = v; },
+                                     wanted);
+                bytes += reply.size();
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+
+            printf("%-17s: %.1f ns/op, %.2f allocs/op (%zu replies, %.2f ns/byte, %d values)\n",
+                   label, ns, double(t_allocations - allocs_start) / iterations, replies.size(),
+                   ns * iterations / bytes, decoded);
+        };
+        bench_parse("reply parse", TELEMETRY_ALL);
+        bench_parse("reply parse (att)", TELEMETRY_ATTITUDE | TELEMETRY_POSITION | TELEMETRY_PHYSICS_TIME);
+    }
+
+    // Cost of one histogram record, including both clock reads
+    {
+        ExchangeLatency latency;
+        const int iterations = 1000000;
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            auto a = std::chrono::steady_clock::now();
+            latency.record(ExchangeStage::Parse, a, std::chrono::steady_clock::now());
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        printf("latency record   : %.1f ns/op\n",
+               std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations);
+    }
+
+    // Before any RFInterface thread exists, so they are all counted
+    SyscallCounter syscalls;
+    syscalls.open();
+
+    int rc = 0;
+    {
+        RFInterface sim(host, port, false);
+        if (use_uring && !sim.set_io_uring(true)) {
+            std::cerr << "[INFO] io_uring unavailable, benchmarking the socket path" << std::endl;
+        }
+        if (record_path && !sim.start_recording(record_path)) {
+            rc = 1;
+        }
+        if (capture_path && !sim.start_capture(capture_path)) {
+            rc = 1;
+        }
+        if (rc != 0) {
+            // start_recording() / start_capture() already said why
+        } else if (!sim.connect()) {
+            std::cerr << "[ERROR] Could not connect to " << host << ":" << port << std::endl;
+            rc = 1;
+        } else if (pipeline > 0) {
+            // Free-running update() loop
+            sim.set_pipeline_depth(pipeline);
+            sim.set_scheduler(sched);
+            sim.reset_latency();
+
+            // Consumer reacting to each new frame through wait_for_state()
+            std::atomic_bool consuming{true};
+            std::vector<double> wake_us;
+            wake_us.reserve(1 << 20);
+            std::thread consumer([&] {
+                uint64_t last = 0;
+                while (consuming.load()) {
+                    StateSnapshot snap = sim.wait_for_state(last, 100);
+                    if (snap.frame <= last) continue;
+                    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count();
+                    if (wake_us.size() < wake_us.capacity()) wake_us.push_back((now - snap.host_time_ns) / 1e3);
+                    last = snap.frame;
+                }
+            });
+
+            double cpu_start = cpu_seconds();
+            auto wall_start = std::chrono::steady_clock::now();
+            sim.start();
+            std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+            sim.stop();
+            consuming.store(false);
+            consumer.join();
+            double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+            double cpu = cpu_seconds() - cpu_start;
+
+            uint64_t frames = sim.frames_received();
+            printf("pipeline depth   : %d\n", pipeline);
+            printf("frames           : %llu (%llu stale dropped)\n",
+                   (unsigned long long)frames, (unsigned long long)sim.stale_replies_dropped());
+            printf("frames/sec       : %.1f\n", frames / wall);
+            printf("cpu per frame    : %.1f us (process, all threads)\n", frames ? cpu / frames * 1e6 : 0.0);
+            print_sim_clock(sim);
+
+            if (sched.rate_hz > 0) {
+                SchedulerStats st = sim.scheduler_stats();
+                printf("scheduler        : %.0f Hz, %llu cycles, %llu overruns (%llu periods missed)\n",
+                       sched.rate_hz, (unsigned long long)st.cycles, (unsigned long long)st.overruns,
+                       (unsigned long long)st.missed_periods);
+                printf("wake jitter      : mean %.1f us, max %.1f us\n",
+                       st.mean_jitter_ns / 1e3, st.max_jitter_ns / 1e3);
+            }
+
+            std::sort(wake_us.begin(), wake_us.end());
+            printf("waiter saw       : %zu frames, publish-to-wake p50 %.1f us, p99 %.1f us\n",
+                   wake_us.size(), percentile(wake_us, 50), percentile(wake_us, 99));
+            printf("\n");
+            sim.print_latency();
+
+            if (drop_physics_time > 0 && !check_malformed(sim)) rc = 1;
+
+            sim.disconnect();
+            sim.stop_recording();
+            sim.stop_capture();
+        } else {
+            RFCmd cmd = {0.5, 0.5, 0.5, 0.5, 0.0, 0.0};
+
+            // Warm up the pool and the server
+            for (int i = 0; i < 100; i++) sim.exchange_data(cmd);
+            sim.reset_latency();
+
+            std::vector<double> rtt_us;
+            rtt_us.reserve(count);
+            int failures = 0;
+
+            uint64_t allocs_start = t_allocations;
+            uint64_t enters_start = sim.io_uring_enters();
+            uint64_t syscalls_start = syscalls.read_count();
+            double cpu_start = cpu_seconds();
+            auto wall_start = std::chrono::steady_clock::now();
+
+            for (int i = 0; i < count; i++) {
+                cmd.aileron = (i % 100) / 100.0;
+                auto t0 = std::chrono::steady_clock::now();
+                bool ok = sim.exchange_data(cmd);
+                auto t1 = std::chrono::steady_clock::now();
+                if (ok) {
+                    rtt_us.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+                } else {
+                    failures++;
+                }
+            }
+
+            double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+            double cpu = cpu_seconds() - cpu_start;
+            uint64_t calls = syscalls.read_count() - syscalls_start;
+            uint64_t allocs = t_allocations - allocs_start;
+
+            std::sort(rtt_us.begin(), rtt_us.end());
+
+            printf("transport        : %s\n", sim.io_uring_active() ? "io_uring" : "sockets");
+            printf("exchanges        : %d (%d failed)\n", count, failures);
+            printf("exchanges/sec    : %.1f\n", count / wall);
+            printf("rtt p50          : %.1f us\n", percentile(rtt_us, 50));
+            printf("rtt p90          : %.1f us\n", percentile(rtt_us, 90));
+            printf("rtt p99          : %.1f us\n", percentile(rtt_us, 99));
+            printf("rtt p99.9        : %.1f us\n", percentile(rtt_us, 99.9));
+            printf("rtt max          : %.1f us\n", rtt_us.empty() ? 0.0 : rtt_us.back());
+            printf("cpu per exchange : %.1f us (process, all threads)\n", cpu / count * 1e6);
+            if (syscalls.ok()) {
+                printf("syscalls/exchange: %.2f (process, all threads)\n", double(calls) / count);
+            } else {
+                printf("syscalls/exchange: n/a (needs tracefs and perf events)\n");
+            }
+            if (sim.io_uring_active()) {
+                printf("uring enters/ex  : %.2f\n", double(sim.io_uring_enters() - enters_start) / count);
+            }
+            printf("allocs/exchange  : %.2f (exchange thread)\n", double(allocs) / count);
+            print_sim_clock(sim);
+            printf("\n");
+            sim.print_latency();
+
+            if (drop_physics_time > 0 && !check_malformed(sim)) rc = 1;
+
+            sim.disconnect();
+            sim.stop_recording();
+            sim.stop_capture();
+        }
+    }
+
+    if (server_pid > 0) {
+        kill(server_pid, SIGTERM);
+        waitpid(server_pid, nullptr, 0);
+    }
+    return rc;
+}
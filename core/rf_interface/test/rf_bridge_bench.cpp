@@ -0,0 +1,184 @@
+// Link loop jitter with and without a heavily loaded consumer.
+//
+// Stands in for a ROS 2 node: the "executor" is a consumer thread that does
+// slow work per state (serialization, callbacks) and stalls now and then
+// (DDS, logging), plus background threads keeping the CPUs busy. Three runs:
+//
+//   bridge/idle    LinkBridge, consumer does nothing
+//   bridge/loaded  LinkBridge, consumer and load threads busy
+//   inline/loaded  same load, but the consumer work runs on the link thread
+//                  after every exchange (publishing straight from the loop)
+//
+// Usage: rf_bridge_bench [--rate hz] [--seconds s] [--fifo prio] [--cpu n]
+//                        [--work-us us] [--stall-ms ms] [--load-threads n]
+
+#include "RFInterface.hpp"
+#include "link_bridge.hpp"
+#include "mock_link_server.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace RF;
+
+struct Load {
+    int work_us = 200;      // per state
+    int stall_ms = 20;      // once every 100 states
+    int threads = 2;        // busy background threads
+};
+
+static void spin_for(std::chrono::microseconds d) {
+    auto until = std::chrono::steady_clock::now() + d;
+    while (std::chrono::steady_clock::now() < until) {}
+}
+
+// What the executor does with each state
+static void consume(const Load& load, uint64_t n) {
+    spin_for(std::chrono::microseconds(load.work_us));
+    if (load.stall_ms > 0 && n % 100 == 99) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(load.stall_ms));
+    }
+}
+
+struct Result {
+    BridgeStats stats;
+    double seconds;
+};
+
+static void print_result(const char* name, const Result& r) {
+    const SchedulerStats& l = r.stats.loop;
+    printf("%-14s %9.1f %10.1f %10.1f %9llu %9llu %9llu\n", name,
+           r.stats.exchanges / r.seconds, l.mean_jitter_ns / 1e3, l.max_jitter_ns / 1e3,
+           (unsigned long long)l.overruns, (unsigned long long)l.missed_periods,
+           (unsigned long long)r.stats.states_dropped);
+}
+
+static Result run_bridge(RFInterface& sim, const SchedulerConfig& sched, const Load& load,
+                         bool loaded, double seconds) {
+    LinkBridge bridge(sim, sched);
+    bridge.set_command(NEUTRAL_COMMAND);
+
+    std::atomic_bool running{true};
+    std::vector<std::thread> hogs;
+    if (loaded) {
+        for (int i = 0; i < load.threads; i++) {
+            hogs.emplace_back([&] { while (running.load()) {} });
+        }
+    }
+
+    std::thread consumer([&] {
+        uint64_t n = 0;
+        StateSnapshot snap;
+        while (running.load()) {
+            if (!bridge.wait_state(100)) continue;
+            while (bridge.pop_state(snap)) {
+                if (loaded) consume(load, n++);
+                bridge.set_command(NEUTRAL_COMMAND);
+            }
+        }
+    });
+
+    bridge.start();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    bridge.stop();
+
+    running.store(false);
+    consumer.join();
+    for (auto& t : hogs) t.join();
+    return {bridge.stats(), seconds};
+}
+
+// The pre-bridge shape: consume on the link thread itself
+static Result run_inline(RFInterface& sim, const SchedulerConfig& sched, const Load& load, double seconds) {
+    std::atomic_bool running{true};
+    std::vector<std::thread> hogs;
+    for (int i = 0; i < load.threads; i++) {
+        hogs.emplace_back([&] { while (running.load()) {} });
+    }
+
+    Result r;
+    r.seconds = seconds;
+    std::thread link([&] {
+        RateScheduler scheduler(sched);
+        scheduler.apply_realtime();
+        scheduler.start();
+
+        RFCmd cmd = NEUTRAL_COMMAND;
+        auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+        uint64_t n = 0;
+        while (std::chrono::steady_clock::now() < end) {
+            if (sim.exchange_data(cmd)) {
+                r.stats.exchanges++;
+                consume(load, n++);
+            } else {
+                r.stats.failed_exchanges++;
+            }
+            scheduler.wait_next();
+        }
+        r.stats.loop = scheduler.stats();
+    });
+    link.join();
+
+    running.store(false);
+    for (auto& t : hogs) t.join();
+    return r;
+}
+
+int main(int argc, char* argv[]) {
+    SchedulerConfig sched;
+    sched.rate_hz = 500.0;
+    double seconds = 3.0;
+    uint16_t port = 18094;
+    Load load;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            sched.rate_hz = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--fifo") && i + 1 < argc) {
+            sched.fifo_priority = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--cpu") && i + 1 < argc) {
+            sched.cpu = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--work-us") && i + 1 < argc) {
+            load.work_us = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--stall-ms") && i + 1 < argc) {
+            load.stall_ms = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--load-threads") && i + 1 < argc) {
+            load.threads = atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--rate hz] [--seconds s] [--fifo prio] [--cpu n]"
+                      << " [--work-us us] [--stall-ms ms] [--load-threads n]" << std::endl;
+            return 1;
+        }
+    }
+
+    MockLinkServer server(port);
+    if (!server.start()) return 1;
+
+    RFInterface sim("127.0.0.1", port, false);
+    if (!sim.connect()) {
+        std::cerr << "[ERROR] Could not connect to the mock server" << std::endl;
+        return 1;
+    }
+
+    printf("rate %.0f Hz, %.1f s per run, consumer %d us/state + %d ms stall every 100, %d load threads%s\n\n",
+           sched.rate_hz, seconds, load.work_us, load.stall_ms, load.threads,
+           sched.fifo_priority > 0 ? ", link SCHED_FIFO" : "");
+    printf("%-14s %9s %10s %10s %9s %9s %9s\n",
+           "mode", "exch/s", "jitter_us", "max_us", "overruns", "missed", "dropped");
+
+    print_result("bridge/idle", run_bridge(sim, sched, load, false, seconds));
+    print_result("bridge/loaded", run_bridge(sim, sched, load, true, seconds));
+    print_result("inline/loaded", run_inline(sim, sched, load, seconds));
+
+    sim.disconnect();
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,193 @@
+// Many RFInterface instances in one process, each with its own endpoint.
+//
+// Forks one mock server process listening on N consecutive ports, then runs
+// N links against it twice: each link with its own update thread, and all of
+// them on the shared LinkReactor thread (set_reactor_mode). Reports the rate
+// each link actually achieved, the process thread count and CPU per exchange.
+//
+// Usage: rf_fleet_bench [--links n] [--rate hz] [--seconds s] [--port first]
+//                       [--latency-us us] [--depth n] [--mode thread|reactor|both]
+
+#include "RFInterface.hpp"
+#include "mock_link_server.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+using namespace RF;
+
+static double cpu_seconds() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static int thread_count() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 8, "Threads:") == 0) return atoi(line.c_str() + 8);
+    }
+    return -1;
+}
+
+// One process serving `links` ports, so its threads stay out of the counts
+static pid_t spawn_mock_servers(uint16_t first_port, int links, int latency_us) {
+    int ready[2];
+    if (pipe(ready) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        std::vector<std::unique_ptr<MockLinkServer>> servers;
+        bool ok = true;
+        for (int i = 0; i < links && ok; i++) {
+            servers.push_back(std::make_unique<MockLinkServer>(first_port + i));
+            servers.back()->set_reply_delay(std::chrono::microseconds(latency_us));
+            ok = servers.back()->start();
+        }
+        char c = ok ? 1 : 0;
+        if (write(ready[1], &c, 1) != 1 || !ok) _exit(1);
+        close(ready[1]);
+
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGTERM);
+        sigprocmask(SIG_BLOCK, &set, nullptr);
+        int sig;
+        sigwait(&set, &sig);
+        for (auto& s : servers) s->stop();
+        _exit(0);
+    }
+
+    close(ready[1]);
+    char c = 0;
+    if (pid < 0 || read(ready[0], &c, 1) != 1 || c != 1) {
+        close(ready[0]);
+        return -1;
+    }
+    close(ready[0]);
+    return pid;
+}
+
+static bool run_fleet(const char* mode, bool reactor_mode, uint16_t first_port, int links,
+                      const SchedulerConfig& sched, size_t depth, double seconds) {
+    std::vector<std::unique_ptr<RFInterface>> sims;
+    for (int i = 0; i < links; i++) {
+        sims.push_back(std::make_unique<RFInterface>("127.0.0.1", first_port + i, false));
+        sims.back()->set_scheduler(sched);
+        sims.back()->set_pipeline_depth(depth);
+        sims.back()->set_reactor_mode(reactor_mode);
+        if (!sims.back()->connect()) {
+            std::cerr << "[ERROR] Link " << i << " could not connect" << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<uint64_t> start_frames(links);
+    for (int i = 0; i < links; i++) {
+        start_frames[i] = sims[i]->frames_received();
+        sims[i]->start();
+    }
+    double cpu_start = cpu_seconds();
+    auto t0 = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds / 2));
+    int threads = thread_count();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds / 2));
+
+    std::vector<uint64_t> frames(links);
+    for (int i = 0; i < links; i++) {
+        frames[i] = sims[i]->frames_received() - start_frames[i];
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    double cpu = cpu_seconds() - cpu_start;
+
+    uint64_t total = 0, lo = UINT64_MAX, hi = 0;
+    int64_t max_jitter = 0;
+    for (int i = 0; i < links; i++) {
+        total += frames[i];
+        lo = std::min(lo, frames[i]);
+        hi = std::max(hi, frames[i]);
+        max_jitter = std::max(max_jitter, sims[i]->scheduler_stats().max_jitter_ns);
+    }
+    for (auto& sim : sims) sim->stop();
+    for (auto& sim : sims) sim->disconnect();
+
+    printf("%-8s %6d %10.1f %10.1f %10.1f %8d %10.1f %10.1f\n", mode, links,
+           total / elapsed, lo / elapsed, hi / elapsed, threads,
+           total ? cpu / total * 1e6 : 0.0, max_jitter / 1e3);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int links = 8;
+    SchedulerConfig sched;
+    sched.rate_hz = 100.0;
+    double seconds = 3.0;
+    uint16_t first_port = 18100;
+    int latency_us = 200;
+    size_t depth = 1;
+    std::string mode = "both";
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--links") && i + 1 < argc) {
+            links = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            sched.rate_hz = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+            first_port = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--latency-us") && i + 1 < argc) {
+            latency_us = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--depth") && i + 1 < argc) {
+            depth = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--mode") && i + 1 < argc) {
+            mode = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--links n] [--rate hz] [--seconds s] [--port first]"
+                      << " [--latency-us us] [--depth n] [--mode thread|reactor|both]" << std::endl;
+            return 1;
+        }
+    }
+
+    pid_t server = spawn_mock_servers(first_port, links, latency_us);
+    if (server < 0) {
+        std::cerr << "[ERROR] Could not start mock servers on ports " << first_port << "+" << std::endl;
+        return 1;
+    }
+
+    // Keep the per-instance connect chatter out of the table
+    Logger::instance().set_level(LogLevel::Warn);
+    printf("%d links, %s, mock reply delay %d us, pipeline depth %zu, %.1f s per run\n\n", links,
+           sched.rate_hz > 0 ? (std::to_string(static_cast<int>(sched.rate_hz)) + " Hz each").c_str() : "free-running",
+           latency_us, depth, seconds);
+    printf("%-8s %6s %10s %10s %10s %8s %10s %10s\n",
+           "mode", "links", "exch/s", "min_link", "max_link", "threads", "cpu_us/ex", "jitter_us");
+    fflush(stdout);
+
+    bool ok = true;
+    if (mode == "thread" || mode == "both") {
+        ok = run_fleet("thread", false, first_port, links, sched, depth, seconds) && ok;
+        fflush(stdout);
+    }
+    if (mode == "reactor" || mode == "both") {
+        ok = run_fleet("reactor", true, first_port, links, sched, depth, seconds) && ok;
+        fflush(stdout);
+    }
+
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+// Headless flight model behind the RealFlight Link protocol (see
+// flight_model_server.hpp). Point RFInterface, rf_test or the ROS nodes at
+// it to fly closed loop without RealFlight: in lockstep as fast as the
+// client exchanges, or free-running at N times real time.
+//
+// Usage: rf_flight_sim [--port port] [--bind ip] [--lockstep | --speed N]
+//                      [--step-rate hz] [--air altitude airspeed]
+
+#include "flight_model_server.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <signal.h>
+
+using namespace RF;
+
+static FlightModelServer* g_server = nullptr;
+
+void signal_handler(int) {
+    if (g_server) g_server->request_stop();
+}
+
+int main(int argc, char* argv[]) {
+    uint16_t port = 18083;
+    const char* bind_ip = "127.0.0.1";
+    bool lockstep = false;
+    double speed = 1.0;
+    double step_rate = FlightModelServer::DEFAULT_STEP_RATE;
+    FlightModelParams params;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+            port = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--bind") && i + 1 < argc) {
+            bind_ip = argv[++i];
+        } else if (!strcmp(argv[i], "--lockstep")) {
+            lockstep = true;
+        } else if (!strcmp(argv[i], "--speed") && i + 1 < argc) {
+            speed = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--step-rate") && i + 1 < argc) {
+            step_rate = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--air") && i + 2 < argc) {
+            params.start_altitude = atof(argv[++i]);
+            params.start_airspeed = atof(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--port port] [--bind ip] [--lockstep | --speed N]"
+                      << " [--step-rate hz] [--air altitude airspeed]" << std::endl;
+            return 1;
+        }
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    FlightModelServer server(port, bind_ip, params);
+    server.set_lockstep(lockstep);
+    server.set_speed(speed);
+    server.set_step_rate(step_rate);
+    if (!server.open_listener()) {
+        return 1;
+    }
+    g_server = &server;
+
+    std::cout << "[INFO] Flight model on " << bind_ip << ":" << port << ", " << server.step_rate() << " Hz steps, ";
+    if (lockstep) {
+        std::cout << "lockstep" << std::endl;
+    } else {
+        std::cout << server.speed() << "x real time" << std::endl;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    server.run();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double sim_s = server.steps() / server.step_rate();
+    std::cout << "[INFO] " << server.steps() << " steps (" << sim_s << " s simulated) for "
+              << server.exchanges_served() << " ExchangeData in " << wall << " s" << std::endl;
+    return 0;
+}
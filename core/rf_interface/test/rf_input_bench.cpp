@@ -0,0 +1,178 @@
+// Stick-to-simulator latency of the whole input path, without a radio.
+//
+// An EventInjector FIFO stands in for the joystick device and plays a
+// scripted stick sweep (every axis on its own sine) at --event-rate frames
+// per second. A Joystick reads it like /dev/input/eventN and feeds an
+// RFInterface through JoystickSource; the link runs at --rate against a
+// forked MockLinkServer. Every frame's kernel-style event stamp travels in
+// RFCmd, so the run reports, from that stamp:
+//
+//   event -> frame     Joystick reader thread committed the frame
+//   command_age        a request picked the command up
+//   input_to_send      the first request carrying the frame was sent
+//   input_to_state     the state from that request's reply was published
+//
+// Usage: rf_input_bench [--seconds s] [--event-rate hz] [--rate hz]
+//                       [--depth n] [--latency-us us] [--port port] [--reactor]
+
+#include "RFInterface.hpp"
+#include "mock_link_server.hpp"
+#include "event_injector.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace RF;
+
+// Run the mock server in a child process so its CPU time is not billed to us
+static pid_t spawn_mock_server(uint16_t port, int latency_us) {
+    int ready[2];
+    if (pipe(ready) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        MockLinkServer server(port);
+        server.set_reply_delay(std::chrono::microseconds(latency_us));
+        bool ok = server.open_listener();
+        char c = ok ? 1 : 0;
+        if (write(ready[1], &c, 1) != 1 || !ok) _exit(1);
+        close(ready[1]);
+
+        static MockLinkServer* s_server = &server;
+        signal(SIGTERM, [](int) { s_server->request_stop(); });
+        server.run();
+        _exit(0);
+    }
+
+    close(ready[1]);
+    char c = 0;
+    if (pid < 0 || read(ready[0], &c, 1) != 1 || c != 1) {
+        close(ready[0]);
+        return -1;
+    }
+    close(ready[0]);
+    return pid;
+}
+
+static void print_stage(const char* name, const LatencySummary& s) {
+    printf("%-15s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", name, (unsigned long long)s.count,
+           s.mean_us, s.p50_us, s.p90_us, s.p99_us, s.max_us);
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = 3.0;
+    double event_rate = 250.0;
+    SchedulerConfig sched;
+    sched.rate_hz = 100.0;
+    size_t depth = 1;
+    int latency_us = 0;
+    uint16_t port = 18096;
+    bool reactor = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--event-rate") && i + 1 < argc) {
+            event_rate = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            sched.rate_hz = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--depth") && i + 1 < argc) {
+            depth = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--latency-us") && i + 1 < argc) {
+            latency_us = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+            port = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--reactor")) {
+            reactor = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--seconds s] [--event-rate hz] [--rate hz]"
+                      << " [--depth n] [--latency-us us] [--port port] [--reactor]" << std::endl;
+            return 1;
+        }
+    }
+
+    pid_t server_pid = spawn_mock_server(port, latency_us);
+    if (server_pid < 0) {
+        std::cerr << "[ERROR] Could not start mock server on port " << port << std::endl;
+        return 1;
+    }
+
+    EventInjector radio;
+    if (!radio.ok()) return 1;
+
+    int rc = 0;
+    {
+        RFInterface sim("127.0.0.1", port, false);
+        auto source = std::make_unique<JoystickSource>(radio.path());
+        Joystick& joystick = source->joystick();
+        sim.set_command_source(std::move(source));
+        sim.set_scheduler(sched);
+        sim.set_pipeline_depth(depth);
+        sim.set_reactor_mode(reactor);
+
+        if (!joystick.is_reading() || !sim.connect()) {
+            std::cerr << "[ERROR] Could not set up the joystick or connect" << std::endl;
+            rc = 1;
+        } else {
+            sim.reset_latency();
+            sim.start();
+
+            // Scripted sweep: each axis on its own sine over the default range
+            auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(1.0 / event_rate));
+            auto t0 = std::chrono::steady_clock::now();
+            auto next = t0;
+            uint64_t dropped = 0;
+            while (std::chrono::steady_clock::now() - t0 < std::chrono::duration<double>(seconds)) {
+                double t = std::chrono::duration<double>(next - t0).count();
+                for (int code = 0; code < 4; code++) {
+                    radio.axis(code, static_cast<int>(1020 + 1000 * std::sin(2 * M_PI * (0.5 + 0.25 * code) * t)));
+                }
+                if (radio.sync() == 0) dropped++;
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+            // Let the last frames reach the link
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            sim.stop();
+            sim.disconnect();
+
+            printf("%llu frames injected at %.0f Hz (%llu not written), %llu committed, link at %s, depth %zu%s\n\n",
+                   (unsigned long long)radio.frames(), event_rate, (unsigned long long)dropped,
+                   (unsigned long long)joystick.frameCount(),
+                   sched.rate_hz > 0 ? (std::to_string(static_cast<int>(sched.rate_hz)) + " Hz").c_str() : "full speed",
+                   depth, reactor ? ", reactor" : "");
+            printf("%-15s %10s %10s %10s %10s %10s %10s\n", "from event to", "count", "mean_us", "p50_us",
+                   "p90_us", "p99_us", "max_us");
+
+            const LatencyHistogram& h = joystick.frameLatency();
+            LatencySummary frame;
+            frame.count = h.count();
+            frame.mean_us = h.mean() / 1e3;
+            frame.p50_us = h.percentile(50) / 1e3;
+            frame.p90_us = h.percentile(90) / 1e3;
+            frame.p99_us = h.percentile(99) / 1e3;
+            frame.max_us = h.max() / 1e3;
+            print_stage("frame", frame);
+            for (ExchangeStage stage : {ExchangeStage::CommandAge, ExchangeStage::InputToSend,
+                                        ExchangeStage::InputToState}) {
+                print_stage(stage_name(stage), sim.latency_summary(stage));
+            }
+        }
+    }
+
+    kill(server_pid, SIGTERM);
+    waitpid(server_pid, nullptr, 0);
+    return rc;
+}
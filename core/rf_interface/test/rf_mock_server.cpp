@@ -0,0 +1,41 @@
+// Stand-in for the RealFlight Link server. Point rf_test / rf_bench at it to
+// work on RFInterface without a Windows box running RealFlight.
+//
+// Usage: rf_mock_server [port] [bind_ip] [physics_hz]
+
+#include "mock_link_server.hpp"
+
+#include <iostream>
+#include <cstdlib>
+#include <signal.h>
+
+using namespace RF;
+
+static MockLinkServer* g_server = nullptr;
+
+void signal_handler(int) {
+    if (g_server) g_server->request_stop();
+}
+
+int main(int argc, char* argv[]) {
+    uint16_t port = (argc > 1) ? static_cast<uint16_t>(atoi(argv[1])) : 18083;
+    const char* bind_ip = (argc > 2) ? argv[2] : "127.0.0.1";
+    double physics_hz = (argc > 3) ? atof(argv[3]) : 0.0;
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    MockLinkServer server(port, bind_ip);
+    server.set_physics_rate(physics_hz);
+    if (!server.open_listener()) {
+        return 1;
+    }
+    g_server = &server;
+
+    std::cout << "[INFO] Mock RealFlight Link listening on " << bind_ip << ":" << port << std::endl;
+    server.run();
+
+    std::cout << "[INFO] Served " << server.requests_served() << " requests ("
+              << server.exchanges_served() << " ExchangeData)" << std::endl;
+    return 0;
+}
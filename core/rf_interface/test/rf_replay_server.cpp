@@ -0,0 +1,76 @@
+// Serves a capture recorded with RFInterface::start_capture() (rf_bench
+// --capture) back to RFInterface, so the control loop can be run and
+// regression-tested on real simulator traffic without RealFlight.
+//
+// Usage: rf_replay_server <capture> [--port port] [--bind ip]
+//                         [--speed factor | --fast] [--loop]
+
+#include "replay_server.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <signal.h>
+
+using namespace RF;
+
+static ReplayServer* g_server = nullptr;
+
+void signal_handler(int) {
+    if (g_server) g_server->request_stop();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <capture> [--port port] [--bind ip]"
+                  << " [--speed factor | --fast] [--loop]" << std::endl;
+        return 1;
+    }
+
+    const char* capture = argv[1];
+    uint16_t port = 18083;
+    const char* bind_ip = "127.0.0.1";
+    double speed = 1.0;
+    bool loop = false;
+
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+            port = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--bind") && i + 1 < argc) {
+            bind_ip = argv[++i];
+        } else if (!strcmp(argv[i], "--speed") && i + 1 < argc) {
+            speed = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--fast")) {
+            speed = 0.0;
+        } else if (!strcmp(argv[i], "--loop")) {
+            loop = true;
+        } else {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    ReplayServer server(port, bind_ip);
+    if (!server.load(capture) || !server.open_listener()) {
+        return 1;
+    }
+    server.set_speed(speed);
+    server.set_loop(loop);
+    g_server = &server;
+
+    std::cout << "[INFO] Replaying " << server.frames() << " frames (" << server.captured_seconds()
+              << " s captured) on " << bind_ip << ":" << port << " at "
+              << (speed > 0 ? std::to_string(speed) + "x" : std::string("full speed")) << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    server.run();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[INFO] Served " << server.exchanges_served() << " ExchangeData in " << wall << " s ("
+              << server.exchanges_served() / wall << " /s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,228 @@
+// Closed-loop flight through the unmodified RFInterface against the
+// built-in flight model (FlightModelServer), as a smoke test for autonomy
+// code and a measure of how fast it can be run.
+//
+// A simple altitude / heading / airspeed autopilot flies a fixed plan
+// (climb and turn east, then descend and turn west) for --seconds of
+// simulated time. By default the server is in lockstep and the loop is
+// serial exchange_data(), so physics runs as fast as the link exchanges;
+// --speed N instead free-runs the model at N times real time and flies
+// through the update() thread, set_command() and wait_for_state().
+//
+// Reports steps per wall second, simulated seconds per wall second, the
+// tracking error at the end of each leg, and heap allocations made by the
+// model and its reply builder. Exits 1 if the aircraft crashed, missed
+// the plan, or the model allocated.
+//
+// Usage: rf_sim_bench [--seconds s] [--speed N] [--rate hz] [--step-rate hz]
+//                     [--port port]
+
+#include "RFInterface.hpp"
+#include "flight_model_server.hpp"
+#include "alloc_counter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+using namespace RF;
+
+// Counts what the model and reply builder allocate, past the first replies
+// (the reply string growing to size)
+class CountingServer : public FlightModelServer {
+public:
+    using FlightModelServer::FlightModelServer;
+
+    static constexpr uint64_t WARMUP = 16;
+
+    uint64_t allocations() const { return m_allocations.load(); }
+    bool crashed() const { return m_crashed.load(); }
+
+protected:
+    void exchange_reply(const char* body, size_t len, std::string& reply) override {
+        uint64_t before = t_allocations;
+        FlightModelServer::exchange_reply(body, len, reply);
+        if (++m_replies > WARMUP) m_allocations += t_allocations - before;
+        m_crashed.store(model().crashed());
+    }
+
+private:
+    uint64_t m_replies = 0;
+    std::atomic<uint64_t> m_allocations{0};
+    std::atomic_bool m_crashed{false};
+};
+
+struct Leg {
+    double until_s;
+    double altitude;  // m
+    double heading;   // deg
+};
+
+static constexpr Leg PLAN[] = {
+    {60.0, 120.0, 90.0},
+    {120.0, 100.0, -90.0},
+};
+static constexpr double AIRSPEED = 18.0;
+
+static double wrap180(double deg) {
+    deg = std::fmod(deg + 180.0, 360.0);
+    return (deg < 0 ? deg + 360.0 : deg) - 180.0;
+}
+
+static double clamp(double v, double lo, double hi) {
+    return std::min(hi, std::max(lo, v));
+}
+
+// Successive loops: heading -> bank -> aileron, altitude -> pitch -> elevator
+static RFCmd autopilot(const AircraftState& s, const Leg& leg) {
+    double climb = -s.m_velocityWorldW_MPS;
+    double roll_target = clamp(1.2 * wrap180(leg.heading - s.m_azimuth_DEG), -30.0, 30.0);
+    double pitch_target = clamp(0.6 * (leg.altitude - s.m_altitudeASL_MTR) - 1.5 * climb, -10.0, 12.0);
+
+    RFCmd cmd = NEUTRAL_COMMAND;
+    cmd.aileron = 0.5 + clamp(0.02 * (roll_target - s.m_roll_DEG) - 0.002 * s.m_rollRate_DEGpSEC, -0.5, 0.5);
+    cmd.elevator = 0.5 + clamp(0.03 * (pitch_target - s.m_inclination_DEG) - 0.004 * s.m_pitchRate_DEGpSEC +
+                               0.004 * std::fabs(s.m_roll_DEG), -0.5, 0.5);
+    cmd.throttle = clamp(0.35 + 0.08 * (AIRSPEED - s.m_airspeed_MPS) + 0.02 * pitch_target, 0.0, 1.0);
+    return cmd;
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = PLAN[1].until_s;
+    double speed = 0.0;  // 0 = lockstep
+    double rate_hz = 200.0;
+    double step_rate = FlightModelServer::DEFAULT_STEP_RATE;
+    uint16_t port = 18097;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--speed") && i + 1 < argc) {
+            speed = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            rate_hz = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--step-rate") && i + 1 < argc) {
+            step_rate = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+            port = static_cast<uint16_t>(atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--seconds s] [--speed N] [--rate hz] [--step-rate hz]"
+                      << " [--port port]" << std::endl;
+            return 1;
+        }
+    }
+
+    FlightModelParams params;
+    params.start_altitude = 100.0;
+    params.start_airspeed = AIRSPEED;
+    CountingServer server(port, "127.0.0.1", params);
+    server.set_lockstep(speed <= 0);
+    server.set_speed(speed);
+    server.set_step_rate(step_rate);
+    if (!server.start()) {
+        return 1;
+    }
+
+    RFInterface sim("127.0.0.1", port, false);
+    if (!sim.connect()) {
+        std::cerr << "[ERROR] Could not connect to the flight model on port " << port << std::endl;
+        server.stop();
+        return 1;
+    }
+
+    // Tracking error at the end of each leg
+    const size_t num_legs = sizeof(PLAN) / sizeof(PLAN[0]);
+    double altitude_error[num_legs] = {};
+    double heading_error[num_legs] = {};
+    size_t leg = 0;
+    uint64_t failures = 0;
+    auto fly = [&](const AircraftState& s) -> const Leg& {
+        double t = s.m_currentPhysicsTime_SEC;
+        while (leg + 1 < num_legs && t >= PLAN[leg].until_s) leg++;
+        altitude_error[leg] = s.m_altitudeASL_MTR - PLAN[leg].altitude;
+        heading_error[leg] = wrap180(s.m_azimuth_DEG - PLAN[leg].heading);
+        return PLAN[leg];
+    };
+
+    auto wall_start = std::chrono::steady_clock::now();
+    uint64_t steps_start = server.steps();
+    double sim_time = 0.0;
+    if (speed <= 0) {
+        // Lockstep: one step per exchange, each command from the last state
+        RFCmd cmd = NEUTRAL_COMMAND;
+        while (sim_time < seconds && !server.crashed()) {
+            if (!sim.exchange_data(cmd)) {
+                if (++failures > 10) break;
+                continue;
+            }
+            StateSnapshot snap = sim.get_state();
+            sim_time = snap.state.m_currentPhysicsTime_SEC;
+            cmd = autopilot(snap.state, fly(snap.state));
+        }
+    } else {
+        // Free-running: the update thread polls at rate_hz, the autopilot
+        // answers each new physics step
+        SchedulerConfig sched;
+        sched.rate_hz = rate_hz;
+        sim.set_scheduler(sched);
+        sim.start();
+        uint64_t last = 0;
+        while (sim_time < seconds && !server.crashed()) {
+            StateSnapshot snap = sim.wait_for_state(last, 1000);
+            if (snap.frame <= last) {
+                if (++failures > 10) break;
+                continue;
+            }
+            last = snap.frame;
+            sim_time = snap.state.m_currentPhysicsTime_SEC;
+            sim.set_command(autopilot(snap.state, fly(snap.state)));
+        }
+        sim.stop();
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    uint64_t steps = server.steps() - steps_start;
+
+    sim.disconnect();
+    server.stop();
+
+    printf("mode             : %s\n", speed <= 0 ? "lockstep" : "free-running");
+    if (speed > 0) printf("speed            : %.1fx real time, update() at %.0f Hz\n", speed, rate_hz);
+    printf("steps            : %llu at %.0f Hz (%.1f s simulated)\n",
+           (unsigned long long)steps, server.step_rate(), sim_time);
+    printf("steps/sec        : %.1f\n", steps / wall);
+    printf("sim s / wall s   : %.1f\n", sim_time / wall);
+    printf("frames           : %llu (%llu repeated steps dropped)\n",
+           (unsigned long long)sim.frames_received(), (unsigned long long)sim.repeated_replies_dropped());
+    for (size_t i = 0; i < num_legs; i++) {
+        printf("leg %zu            : %.0f m, %.0f deg: altitude error %.1f m, heading error %.1f deg\n",
+               i + 1, PLAN[i].altitude, PLAN[i].heading, altitude_error[i], heading_error[i]);
+    }
+    printf("model allocs     : %llu\n", (unsigned long long)server.allocations());
+
+    int rc = 0;
+    if (server.crashed()) {
+        std::cerr << "[ERROR] Crashed at " << sim_time << " s" << std::endl;
+        rc = 1;
+    }
+    if (sim_time < seconds) {
+        std::cerr << "[ERROR] Link failed at " << sim_time << " s" << std::endl;
+        rc = 1;
+    }
+    for (size_t i = 0; i < num_legs && rc == 0; i++) {
+        if (seconds >= PLAN[i].until_s && (std::fabs(altitude_error[i]) > 5.0 || std::fabs(heading_error[i]) > 10.0)) {
+            std::cerr << "[ERROR] Leg " << i + 1 << " not flown" << std::endl;
+            rc = 1;
+        }
+    }
+    if (server.allocations() > 0) {
+        std::cerr << "[ERROR] The flight model allocated" << std::endl;
+        rc = 1;
+    }
+    return rc;
+}
@@ -0,0 +1,358 @@
+// Microbenchmarks for the hot paths of the core libraries.
+//
+// Each benchmark is run with a growing iteration count until one run takes
+// at least --min-time, and that run is reported as ns/op and heap
+// allocations/op. Allocations are counted per thread, so the socket pool and
+// joystick background threads do not show up; multi-threaded benchmarks add
+// up their workers.
+//
+// Benchmarks marked as allocation-free in the table (the exchange thread's
+// per-frame work) make the run exit 1 if they allocate, so a regression fails
+// a scripted run before it reaches the aircraft.
+//
+// A MockLinkServer is forked on loopback for the socket pool and RFInterface
+// benchmarks. --capture adds every ExchangeData reply of a wire capture
+// (start_capture(), rf_bench --capture) as an extra parse fixture.
+//
+// Usage: seeker_bench [filter] [--min-time s] [--port port] [--capture file]
+
+#include "RFInterface.hpp"
+#include "soap_request.hpp"
+#include "reply_parser.hpp"
+#include "wire_capture.hpp"
+#include "mock_link_server.hpp"
+#include "joystick.hpp"
+#include "seqlock.hpp"
+#include "alloc_counter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace RF;
+
+static struct input_event input(uint16_t type, uint16_t code, int32_t value) {
+    struct input_event ev{};
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    return ev;
+}
+
+// Keep the compiler from dropping a result it can see is unused
+template <typename T>
+static inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+class Suite {
+public:
+    Suite(const char* filter, double min_time) : m_filter(filter), m_min_time(min_time) {}
+
+    // body(n) performs n operations. Benchmarks that run worker threads
+    // report those threads' allocations through add_worker_allocs().
+    template <typename F>
+    void run(const char* name, bool alloc_free, F&& body) {
+        if (m_filter && !strstr(name, m_filter)) return;
+
+        uint64_t n = 1;
+        double seconds = 0;
+        uint64_t allocs = 0;
+        while (true) {
+            m_worker_allocs.store(0);
+            uint64_t allocs_start = t_allocations;
+            auto t0 = std::chrono::steady_clock::now();
+            body(n);
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            allocs = t_allocations - allocs_start + m_worker_allocs.load();
+            if (seconds >= m_min_time) break;
+
+            // Aim a little past min_time, growing at most 100x per step
+            double scale = seconds > 0 ? 1.4 * m_min_time / seconds : 100.0;
+            n = static_cast<uint64_t>(n * std::min(100.0, std::max(2.0, scale)));
+        }
+
+        double allocs_per_op = double(allocs) / n;
+        bool regressed = alloc_free && allocs > 0;
+        printf("%-36s %12llu %10.1f %10.2f%s\n", name, static_cast<unsigned long long>(n),
+               seconds * 1e9 / n, allocs_per_op, regressed ? "  <- should not allocate" : "");
+        fflush(stdout);
+        if (regressed) m_failed = true;
+    }
+
+    void add_worker_allocs(uint64_t allocs) { m_worker_allocs.fetch_add(allocs); }
+    bool failed() const { return m_failed; }
+
+private:
+    const char* m_filter;
+    double m_min_time;
+    std::atomic<uint64_t> m_worker_allocs{0};
+    bool m_failed = false;
+};
+
+// Run the mock server in a child process so its CPU time is not billed to us
+static pid_t spawn_mock_server(uint16_t port) {
+    int ready[2];
+    if (pipe(ready) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        MockLinkServer server(port);
+        bool ok = server.open_listener();
+        char c = ok ? 1 : 0;
+        if (write(ready[1], &c, 1) != 1 || !ok) _exit(1);
+        close(ready[1]);
+
+        static MockLinkServer* s_server = &server;
+        signal(SIGTERM, [](int) { s_server->request_stop(); });
+        server.run();
+        _exit(0);
+    }
+
+    close(ready[1]);
+    char c = 0;
+    if (pid < 0 || read(ready[0], &c, 1) != 1 || c != 1) {
+        close(ready[0]);
+        return -1;
+    }
+    close(ready[0]);
+    return pid;
+}
+
+// Reply bodies of increasing size, built from the mock server's reply
+struct ReplyFixture : MockLinkServer {
+    std::string full() {
+        std::string reply;
+        const char* body = "<item>0.5</item>";
+        exchange_reply(body, strlen(body), reply);
+        return reply;
+    }
+
+    // Channel values and the physics time only
+    std::string minimal() {
+        std::string reply = "<ReturnData><m-previousInputsState><m-channelValues-0to1>";
+        for (int i = 0; i < NUM_RCIN; i++) append_value(reply, "item", 0.5);
+        reply += "</m-channelValues-0to1></m-previousInputsState><m-aircraftState>";
+        append_value(reply, "m-currentPhysicsTime-SEC", 12.345);
+        reply += "</m-aircraftState></ReturnData>";
+        return reply;
+    }
+
+    // The full reply behind `extra` bytes of fields the schema does not know,
+    // which the parser has to walk past (aircraft with more state than ours)
+    std::string padded(size_t extra) {
+        std::string reply = full();
+        std::string filler;
+        for (int i = 0; filler.size() < extra; i++) {
+            std::string tag = "m-unlistedField" + std::to_string(i);
+            append_value(filler, tag.c_str(), i * 0.25);
+        }
+        size_t at = reply.find("<m-aircraftState>") + strlen("<m-aircraftState>");
+        return reply.insert(at, filler);
+    }
+};
+
+static void bench_parse(Suite& suite, const char* name, const std::vector<std::string>& replies,
+                        TelemetryMask wanted) {
+    AircraftState parsed;
+    size_t next = 0;
+    // The decode RFInterface::parse_reply() runs on every accepted reply
+    suite.run(name, true, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            const std::string& reply = replies[next];
+            next = next + 1 == replies.size() ? 0 : next + 1;
+            int decoded = scan_reply(reply.data(), reply.data() + reply.size(),
+                                     [&](int idx, double v) { parsed.rcin[idx] = v; },
+                                     [&](int idx, double v) { telemetry_value(parsed, idx) = v; },
+                                     wanted);
+            keep(decoded);
+        }
+        keep(parsed);
+    });
+}
+
+// `threads` threads taking a pooled socket and hanging up, as pipelined
+// update() does once per request. Includes waiting for the reactor to
+// connect replacements once the pool runs dry.
+static void bench_get_socket(Suite& suite, const char* name, SocketPool& pool, int threads) {
+    suite.run(name, false, [&](uint64_t n) {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            uint64_t share = n / threads + (uint64_t(t) < n % threads ? 1 : 0);
+            workers.emplace_back([&suite, &pool, share] {
+                uint64_t allocs_start = t_allocations;
+                for (uint64_t i = 0; i < share; i++) {
+                    int sock = pool.get_socket(100);
+                    if (sock < 0) continue;
+                    // Reset rather than close: thousands of TIME_WAIT
+                    // sockets would run loopback out of ports
+                    struct linger lg = {1, 0};
+                    setsockopt(sock, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+                    close(sock);
+                }
+                suite.add_worker_allocs(t_allocations - allocs_start);
+            });
+        }
+        for (auto& w : workers) w.join();
+    });
+}
+
+int main(int argc, char* argv[]) {
+    const char* filter = nullptr;
+    double min_time = 0.2;
+    uint16_t port = 18095;
+    const char* capture_path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--min-time") && i + 1 < argc) {
+            min_time = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+            port = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--capture") && i + 1 < argc) {
+            capture_path = argv[++i];
+        } else if (argv[i][0] != '-' && !filter) {
+            filter = argv[i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [filter] [--min-time s] [--port port] [--capture file]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    pid_t server_pid = spawn_mock_server(port);
+    if (server_pid < 0) {
+        std::cerr << "[ERROR] Could not start mock server on port " << port << std::endl;
+        return 1;
+    }
+
+    // Connect chatter and the missing joystick are not what is being measured
+    Logger::instance().set_level(LogLevel::Off);
+
+    Suite suite(filter, min_time);
+    printf("%-36s %12s %10s %10s\n", "benchmark", "iterations", "ns/op", "allocs/op");
+
+    // Request building
+    {
+        ExchangeRequest request;
+        double channels[ExchangeRequest::NUM_CHANNELS] = {0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0, 0.5, 0.5, 0.5, 0.5};
+        suite.run("request build", true, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                channels[0] = (i % 1000) / 1000.0;
+                request.set_channels(channels);
+                keep(request.size());
+            }
+        });
+    }
+
+    // Reply parsing, by fixture size
+    {
+        ReplyFixture fixture;
+        std::vector<std::pair<std::string, std::vector<std::string>>> fixtures = {
+            {"minimal", {fixture.minimal()}},
+            {"full", {fixture.full()}},
+            {"padded 16k", {fixture.padded(16384)}},
+        };
+        if (capture_path) {
+            std::vector<CaptureEntry> entries;
+            std::vector<std::string> replies;
+            read_wire_capture(capture_path, entries);
+            for (const CaptureEntry& e : entries) {
+                size_t body = e.bytes.find("\r\n\r\n");
+                if (e.kind == CAPTURE_RESPONSE && body != std::string::npos &&
+                    e.bytes.find("<ReturnData>") != std::string::npos) {
+                    replies.push_back(e.bytes.substr(body + 4));
+                }
+            }
+            if (replies.empty()) {
+                std::cerr << "[WARN] No ExchangeData replies in " << capture_path << std::endl;
+            } else {
+                fixtures.push_back({"capture", std::move(replies)});
+            }
+        }
+
+        for (auto& f : fixtures) {
+            size_t bytes = 0;
+            for (const std::string& r : f.second) bytes += r.size();
+            std::string name = "parse_reply " + f.first + " (" + std::to_string(bytes / f.second.size()) + " B)";
+            bench_parse(suite, name.c_str(), f.second, TELEMETRY_ALL);
+        }
+        std::vector<std::string> full = {fixture.full()};
+        bench_parse(suite, "parse_reply full, attitude only", full,
+                    TELEMETRY_ATTITUDE | TELEMETRY_POSITION | TELEMETRY_PHYSICS_TIME);
+    }
+
+    // Joystick axis mapping, without a device
+    {
+        Joystick joystick("/nonexistent/seeker_bench");
+        suite.run("Joystick EV_ABS", true, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) joystick.handleEvent(input(EV_ABS, i & 3, int(i & 2047)));
+        });
+        suite.run("Joystick EV_KEY", true, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) joystick.handleEvent(input(EV_KEY, BTN_TRIGGER, int(i & 1)));
+        });
+        // Four axes and the SYN_REPORT that publishes them
+        suite.run("Joystick frame (4 axes + SYN_REPORT)", true, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                int value = int(i & 2047);
+                for (int code = 0; code < 4; code++) joystick.handleEvent(input(EV_ABS, code, value));
+                joystick.handleEvent(input(EV_SYN, SYN_REPORT, 0));
+            }
+        });
+        suite.run("Joystick::getJoystickVals", true, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(joystick.getJoystickVals());
+        });
+    }
+
+    // State snapshot reads
+    {
+        RFInterface sim("127.0.0.1", port, false);
+        suite.run("RFInterface::get_state", true, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) keep(sim.get_state());
+        });
+
+        // Same seqlock with the update thread publishing at 1 kHz
+        SeqLock<StateSnapshot> snapshot;
+        std::atomic_bool writing{true};
+        std::thread writer([&] {
+            StateSnapshot s{};
+            while (writing.load()) {
+                s.frame++;
+                snapshot.store(s);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        suite.run("snapshot load, 1 kHz writer", true, [&](uint64_t n) {
+            StateSnapshot s;
+            for (uint64_t i = 0; i < n; i++) {
+                snapshot.load(s);
+                keep(s);
+            }
+        });
+        writing.store(false);
+        writer.join();
+    }
+
+    // Socket pool hand-out under contention
+    {
+        SocketPool pool("127.0.0.1", port, 8);
+        bench_get_socket(suite, "SocketPool::get_socket, 1 thread", pool, 1);
+        bench_get_socket(suite, "SocketPool::get_socket, 2 threads", pool, 2);
+        bench_get_socket(suite, "SocketPool::get_socket, 4 threads", pool, 4);
+    }
+
+    kill(server_pid, SIGTERM);
+    waitpid(server_pid, nullptr, 0);
+    return suite.failed() ? 1 : 0;
+}
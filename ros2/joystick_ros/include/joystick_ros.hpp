@@ -1,7 +1,43 @@
 #include <rclcpp/rclcpp.hpp>
 #include <rclcpp/visibility_control.hpp>
 #include <rclcpp/clock.hpp>
+#include <seeker_msgs/msg/rf_cmd.hpp>
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
 
 #include "joystick.hpp"
 
+namespace joystick_ros
+{
+
+// Publishes every committed joystick frame on rf_cmd as soon as the evdev
+// reader thread commits it. A dedicated thread waits on the frame (no
+// polling timer), and each message carries the steady clock time of the
+// kernel input event behind it, so the RF link can report stick-to-exchange
+// latency.
+//
+// Loaded into the same component container as rf_interface_ros with
+// intra-process comms enabled, the message reaches the link's subscription
+// by pointer, without serialization.
+class JoystickNode : public rclcpp::Node
+{
+public:
+  explicit JoystickNode(const rclcpp::NodeOptions & options = rclcpp::NodeOptions());
+  ~JoystickNode() override;
+
+private:
+  void publish_loop();
+
+  std::string m_device;   // Joystick keeps a pointer to it
+  std::unique_ptr<Joystick> m_joystick;
+
+  rclcpp::Publisher<seeker_msgs::msg::RFCmd>::SharedPtr m_cmd_pub;
+
+  std::atomic_bool m_running{false};
+  std::thread m_publish_thread;
+};
+
+}  // namespace joystick_ros
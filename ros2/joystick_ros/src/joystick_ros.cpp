@@ -0,0 +1,69 @@
+#include "joystick_ros.hpp"
+
+#include <rclcpp_components/register_node_macro.hpp>
+
+#include <chrono>
+
+namespace joystick_ros
+{
+
+JoystickNode::JoystickNode(const rclcpp::NodeOptions & options)
+: Node("joystick_node", options)
+{
+  m_device = declare_parameter<std::string>("device", "/dev/input/event0");
+
+  m_cmd_pub = create_publisher<seeker_msgs::msg::RFCmd>("rf_cmd", rclcpp::SensorDataQoS());
+
+  m_joystick = std::make_unique<Joystick>(m_device.c_str());
+  if (!m_joystick->is_reading()) {
+    RCLCPP_ERROR(get_logger(), "Cannot read joystick at %s", m_device.c_str());
+    return;
+  }
+
+  RCLCPP_INFO(get_logger(), "Joystick Node started (%s, intra-process %s)", m_device.c_str(),
+              options.use_intra_process_comms() ? "on" : "off");
+
+  m_running.store(true);
+  m_publish_thread = std::thread(&JoystickNode::publish_loop, this);
+}
+
+JoystickNode::~JoystickNode()
+{
+  m_running.store(false);
+  if (m_publish_thread.joinable()) {
+    m_publish_thread.join();
+  }
+}
+
+void JoystickNode::publish_loop()
+{
+  uint64_t seen = m_joystick->frameCount();
+  while (m_running.load() && rclcpp::ok()) {
+    uint64_t frame = m_joystick->waitForFrame(seen, 100);
+    if (frame == seen) {
+      continue;
+    }
+    seen = frame;
+
+    RF::RFCmd cmd = m_joystick->getJoystickVals();
+
+    // unique_ptr publish: moved to intra-process subscribers, never copied
+    auto msg = std::make_unique<seeker_msgs::msg::RFCmd>();
+    // Stamped with the input event behind the frame, so the link measures
+    // from the stick, not from here
+    msg->host_time_ns = cmd.event_time_ns ? cmd.event_time_ns :
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+    msg->throttle = cmd.throttle;
+    msg->aileron = cmd.aileron;
+    msg->elevator = cmd.elevator;
+    msg->rudder = cmd.rudder;
+    msg->flaps = cmd.flaps;
+    msg->gear = cmd.gear;
+    m_cmd_pub->publish(std::move(msg));
+  }
+}
+
+}  // namespace joystick_ros
+
+RCLCPP_COMPONENTS_REGISTER_NODE(joystick_ros::JoystickNode)
@@ -0,0 +1,40 @@
+# Joystick and RF link in one container with intra-process comms: rf_cmd is
+# handed over by pointer, no serialization. Compare the stick-to-exchange
+# latency that rf_interface_node reports against split.launch.py.
+from launch import LaunchDescription
+from launch.actions import DeclareLaunchArgument
+from launch.substitutions import LaunchConfiguration
+from launch_ros.actions import ComposableNodeContainer
+from launch_ros.descriptions import ComposableNode
+
+
+def generate_launch_description():
+    device = LaunchConfiguration('device')
+    rf_ip = LaunchConfiguration('rf_ip')
+    intra = {'use_intra_process_comms': True}
+
+    return LaunchDescription([
+        DeclareLaunchArgument('device', default_value='/dev/input/event0'),
+        DeclareLaunchArgument('rf_ip', default_value='127.0.0.1'),
+        ComposableNodeContainer(
+            name='seeker_container',
+            namespace='',
+            package='rclcpp_components',
+            executable='component_container_mt',
+            composable_node_descriptions=[
+                ComposableNode(
+                    package='joystick_ros',
+                    plugin='joystick_ros::JoystickNode',
+                    parameters=[{'device': device}],
+                    extra_arguments=[intra],
+                ),
+                ComposableNode(
+                    package='rf_interface_ros',
+                    plugin='rf_interface_ros::RFInterfaceNode',
+                    parameters=[{'rf_ip': rf_ip}],
+                    extra_arguments=[intra],
+                ),
+            ],
+            output='screen',
+        ),
+    ])
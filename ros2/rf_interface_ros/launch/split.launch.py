@@ -0,0 +1,28 @@
+# Joystick and RF link as separate processes: every rf_cmd goes through
+# the middleware (serialized, loopback). Baseline for composed.launch.py.
+from launch import LaunchDescription
+from launch.actions import DeclareLaunchArgument
+from launch.substitutions import LaunchConfiguration
+from launch_ros.actions import Node
+
+
+def generate_launch_description():
+    device = LaunchConfiguration('device')
+    rf_ip = LaunchConfiguration('rf_ip')
+
+    return LaunchDescription([
+        DeclareLaunchArgument('device', default_value='/dev/input/event0'),
+        DeclareLaunchArgument('rf_ip', default_value='127.0.0.1'),
+        Node(
+            package='joystick_ros',
+            executable='joystick_node',
+            parameters=[{'device': device}],
+            output='screen',
+        ),
+        Node(
+            package='rf_interface_ros',
+            executable='rf_interface_node',
+            parameters=[{'rf_ip': rf_ip}],
+            output='screen',
+        ),
+    ])
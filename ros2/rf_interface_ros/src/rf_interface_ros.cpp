@@ -1,19 +1,223 @@
 #include <rclcpp/rclcpp.hpp>
+#include <rclcpp_components/register_node_macro.hpp>
+#include <seeker_msgs/msg/aircraft_state.hpp>
+#include <seeker_msgs/msg/rf_cmd.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
 #include "RFInterface.hpp"
+#include "link_bridge.hpp"
 
+namespace rf_interface_ros
+{
+
+// AircraftState.msg mirrors RF::AircraftState field for field
+static void to_msg(const RF::StateSnapshot & snap, const rclcpp::Time & stamp,
+                   seeker_msgs::msg::AircraftState & msg)
+{
+  const RF::AircraftState & s = snap.state;
+
+  msg.stamp = stamp;
+  msg.frame = snap.frame;
+  msg.host_time_ns = snap.host_time_ns;
+  msg.sim_time_ns = snap.sim_time_ns;
+
+  for (int i = 0; i < 12; i++) {
+    msg.rcin[i] = s.rcin[i];
+  }
+  msg.airspeed_mps = s.m_airspeed_MPS;
+  msg.altitude_asl_mtr = s.m_altitudeASL_MTR;
+  msg.altitude_agl_mtr = s.m_altitudeAGL_MTR;
+  msg.groundspeed_mps = s.m_groundspeed_MPS;
+  msg.pitch_rate_degpsec = s.m_pitchRate_DEGpSEC;
+  msg.roll_rate_degpsec = s.m_rollRate_DEGpSEC;
+  msg.yaw_rate_degpsec = s.m_yawRate_DEGpSEC;
+  msg.azimuth_deg = s.m_azimuth_DEG;
+  msg.inclination_deg = s.m_inclination_DEG;
+  msg.roll_deg = s.m_roll_DEG;
+  msg.aircraft_position_x_mtr = s.m_aircraftPositionX_MTR;
+  msg.aircraft_position_y_mtr = s.m_aircraftPositionY_MTR;
+  msg.velocity_world_u_mps = s.m_velocityWorldU_MPS;
+  msg.velocity_world_v_mps = s.m_velocityWorldV_MPS;
+  msg.velocity_world_w_mps = s.m_velocityWorldW_MPS;
+  msg.velocity_body_u_mps = s.m_velocityBodyU_MPS;
+  msg.velocity_body_v_mps = s.m_velocityBodyV_MPS;
+  msg.velocity_body_w_mps = s.m_velocityBodyW_MPS;
+  msg.acceleration_world_ax_mps2 = s.m_accelerationWorldAX_MPS2;
+  msg.acceleration_world_ay_mps2 = s.m_accelerationWorldAY_MPS2;
+  msg.acceleration_world_az_mps2 = s.m_accelerationWorldAZ_MPS2;
+  msg.acceleration_body_ax_mps2 = s.m_accelerationBodyAX_MPS2;
+  msg.acceleration_body_ay_mps2 = s.m_accelerationBodyAY_MPS2;
+  msg.acceleration_body_az_mps2 = s.m_accelerationBodyAZ_MPS2;
+  msg.wind_x_mps = s.m_windX_MPS;
+  msg.wind_y_mps = s.m_windY_MPS;
+  msg.wind_z_mps = s.m_windZ_MPS;
+  msg.prop_rpm = s.m_propRPM;
+  msg.heli_main_rotor_rpm = s.m_heliMainRotorRPM;
+  msg.battery_voltage_volts = s.m_batteryVoltage_VOLTS;
+  msg.battery_current_draw_amps = s.m_batteryCurrentDraw_AMPS;
+  msg.battery_remaining_capacity_mah = s.m_batteryRemainingCapacity_MAH;
+  msg.fuel_remaining_oz = s.m_fuelRemaining_OZ;
+  msg.is_locked = s.m_isLocked > 0.5;
+  msg.has_lost_components = s.m_hasLostComponents > 0.5;
+  msg.an_engine_is_running = s.m_anEngineIsRunning > 0.5;
+  msg.is_touching_ground = s.m_isTouchingGround > 0.5;
+  msg.current_aircraft_status = s.m_currentAircraftStatus;
+  msg.current_physics_time_sec = s.m_currentPhysicsTime_SEC;
+  msg.current_physics_speed_multiplier = s.m_currentPhysicsSpeedMultiplier;
+  msg.orientation_quaternion_x = s.m_orientationQuaternion_X;
+  msg.orientation_quaternion_y = s.m_orientationQuaternion_Y;
+  msg.orientation_quaternion_z = s.m_orientationQuaternion_Z;
+  msg.orientation_quaternion_w = s.m_orientationQuaternion_W;
+  msg.flight_axis_controller_is_active = s.m_flightAxisControllerIsActive > 0.5;
+  msg.reset_button_has_been_pressed = s.m_resetButtonHasBeenPressed > 0.5;
+}
+
+// Runs the RealFlight link on its own thread through RF::LinkBridge, so
+// executor callbacks, DDS and logging cannot stall the exchange loop:
+//  - rf_cmd callbacks only store the latest command (never blocks)
+//  - a publisher thread drains the bridge's state ring and publishes every
+//    frame on aircraft_state; if it falls behind, frames are dropped and
+//    counted, the link keeps its rate
+//
+// States go out through borrow_loaned_message() when the middleware can
+// loan (e.g. shared memory), a true zero-copy publish. Otherwise (the
+// default FastDDS / Cyclone setup) a borrow is just a heap message that
+// skips the intra-process path, so each state is published as a unique_ptr
+// instead: moved to intra-process subscribers without copy or
+// serialization, one allocation per state.
+//
+// Built as a component: loaded into one container with joystick_ros and
+// use_intra_process_comms, a stick frame reaches set_command() without
+// leaving the process (see launch/composed.launch.py). The stats timer
+// reports the stick-to-exchange latency taken from RFCmd.host_time_ns.
 class RFInterfaceNode : public rclcpp::Node
 {
 public:
-  RFInterfaceNode() : Node("rf_interface_node")
+  explicit RFInterfaceNode(const rclcpp::NodeOptions & options = rclcpp::NodeOptions())
+  : Node("rf_interface_node", options)
+  {
+    m_rf_ip = declare_parameter<std::string>("rf_ip", "127.0.0.1");
+    int rf_port = declare_parameter<int>("rf_port", 18083);
+
+    // Link thread pacing and isolation (see RF::SchedulerConfig)
+    RF::SchedulerConfig sched;
+    sched.rate_hz = declare_parameter<double>("rate_hz", 0.0);
+    sched.fifo_priority = declare_parameter<int>("link_fifo_priority", 0);
+    sched.cpu = declare_parameter<int>("link_cpu", -1);
+    sched.lock_memory = declare_parameter<bool>("lock_memory", false);
+
+    // Latest value wins on both topics; a late state is worth less than the next one
+    m_state_pub = create_publisher<seeker_msgs::msg::AircraftState>(
+      "aircraft_state", rclcpp::SensorDataQoS());
+
+    m_sim = std::make_unique<RF::RFInterface>(m_rf_ip.c_str(), static_cast<uint16_t>(rf_port), false);
+    m_bridge = std::make_unique<RF::LinkBridge>(*m_sim, sched);
+
+    // Until the first command arrives
+    m_bridge->set_command(RF::NEUTRAL_COMMAND);
+
+    m_cmd_sub = create_subscription<seeker_msgs::msg::RFCmd>(
+      "rf_cmd", rclcpp::SensorDataQoS(),
+      [this](seeker_msgs::msg::RFCmd::ConstSharedPtr msg) {
+        m_bridge->set_command(
+          RF::RFCmd{msg->throttle, msg->aileron, msg->elevator, msg->rudder, msg->flaps, msg->gear,
+            msg->host_time_ns},
+          msg->host_time_ns);
+      });
+
+    if (!m_sim->connect()) {
+      RCLCPP_ERROR(get_logger(), "Cannot reach RealFlight Link at %s:%d", m_rf_ip.c_str(), rf_port);
+      return;
+    }
+
+    RCLCPP_INFO(get_logger(), "RF Interface Node started (%s:%d, %s, loaned messages %s)",
+                m_rf_ip.c_str(), rf_port,
+                sched.rate_hz > 0 ? "paced" : "free-running",
+                m_state_pub->can_loan_messages() ? "available" : "unavailable");
+
+    m_running.store(true);
+    m_publish_thread = std::thread(&RFInterfaceNode::publish_loop, this);
+    m_bridge->start();
+
+    m_stats_timer = create_wall_timer(std::chrono::seconds(5), [this]() {report_stats();});
+  }
+
+  ~RFInterfaceNode() override
   {
-    RCLCPP_INFO(this->get_logger(), "RF Interface Node started");
+    m_bridge->stop();
+    m_running.store(false);
+    if (m_publish_thread.joinable()) {
+      m_publish_thread.join();
+    }
+    if (m_sim->isRFConnected()) {
+      m_sim->disconnect();
+    }
   }
+
+private:
+  void publish_loop()
+  {
+    const bool loan = m_state_pub->can_loan_messages();
+    RF::StateSnapshot snap;
+    while (m_running.load() && rclcpp::ok()) {
+      if (!m_bridge->wait_state(100)) {
+        continue;
+      }
+      while (m_bridge->pop_state(snap)) {
+        if (loan) {
+          auto msg = m_state_pub->borrow_loaned_message();
+          to_msg(snap, now(), msg.get());
+          m_state_pub->publish(std::move(msg));
+        } else {
+          auto msg = std::make_unique<seeker_msgs::msg::AircraftState>();
+          to_msg(snap, now(), *msg);
+          m_state_pub->publish(std::move(msg));
+        }
+      }
+    }
+  }
+
+  // Latency whenever commands came in; warns only when something was lost
+  void report_stats()
+  {
+    RF::BridgeStats s = m_bridge->stats();
+    if (s.commands_received != m_last_stats.commands_received && s.command_latency_p50_ns > 0) {
+      RCLCPP_INFO(get_logger(), "stick-to-exchange: p50 %.1f us, p99 %.1f us",
+                  s.command_latency_p50_ns / 1e3, s.command_latency_p99_ns / 1e3);
+    }
+    if (s.states_dropped == m_last_stats.states_dropped &&
+      s.failed_exchanges == m_last_stats.failed_exchanges &&
+      s.loop.overruns == m_last_stats.loop.overruns)
+    {
+      m_last_stats = s;
+      return;
+    }
+    RCLCPP_WARN(get_logger(),
+      "link: %llu exchanges (%llu failed), %llu states dropped, %llu commands overwritten, "
+      "%llu overruns, max jitter %.1f us",
+      (unsigned long long)s.exchanges, (unsigned long long)s.failed_exchanges,
+      (unsigned long long)s.states_dropped, (unsigned long long)s.commands_overwritten,
+      (unsigned long long)s.loop.overruns, s.loop.max_jitter_ns / 1e3);
+    m_last_stats = s;
+  }
+
+  std::string m_rf_ip;
+  std::unique_ptr<RF::RFInterface> m_sim;
+  std::unique_ptr<RF::LinkBridge> m_bridge;
+  RF::BridgeStats m_last_stats;
+
+  rclcpp::Publisher<seeker_msgs::msg::AircraftState>::SharedPtr m_state_pub;
+  rclcpp::Subscription<seeker_msgs::msg::RFCmd>::SharedPtr m_cmd_sub;
+  rclcpp::TimerBase::SharedPtr m_stats_timer;
+
+  std::atomic_bool m_running{false};
+  std::thread m_publish_thread;
 };
 
-int main(int argc, char ** argv)
-{
-  rclcpp::init(argc, argv);
-  rclcpp::spin(std::make_shared<RFInterfaceNode>());
-  rclcpp::shutdown();
-  return 0;
-}
+}  // namespace rf_interface_ros
+
+RCLCPP_COMPONENTS_REGISTER_NODE(rf_interface_ros::RFInterfaceNode)